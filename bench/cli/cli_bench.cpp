@@ -0,0 +1,99 @@
+#include <benchmark/benchmark.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "BinaryProtocol.h"
+#include "CliOptions.h"
+#include "Workloads.h"
+
+extern int run(const CliOptions &options);
+
+/**
+ * Text input of the CLI: n insertions of random keys, then n rank queries alternating n and m.
+ */
+static std::string generate_queries(std::size_t n) {
+    const auto keys = random_keys(n);
+    const auto queried_keys = random_keys(n, 7);
+    std::ostringstream input;
+    for (const auto key: keys)
+        input << "k " << key << "\n";
+    for (std::size_t i = 0; i < n; i++) {
+        if (i % 2 == 0)
+            input << "n " << queried_keys[i] << "\n";
+        else
+            input << "m " << i + 1 << "\n";
+    }
+    return input.str();
+}
+
+static void add_record(std::string &input, char code, std::int64_t value) {
+    char bytes[BINARY_RECORD_SIZE];
+    encode_record(BinaryRecord{static_cast<std::uint8_t>(code), value}, bytes);
+    input.append(bytes, BINARY_RECORD_SIZE);
+}
+
+/**
+ * The same queries as generate_queries in the binary protocol.
+ */
+static std::string generate_binary_queries(std::size_t n) {
+    const auto keys = random_keys(n);
+    const auto queried_keys = random_keys(n, 7);
+    std::string input;
+    input.reserve(2 * n * BINARY_RECORD_SIZE);
+    for (const auto key: keys)
+        add_record(input, 'k', key);
+    for (std::size_t i = 0; i < n; i++) {
+        if (i % 2 == 0)
+            add_record(input, 'n', queried_keys[i]);
+        else
+            add_record(input, 'm', static_cast<std::int64_t>(i + 1));
+    }
+    return input;
+}
+
+/**
+ * Runs the whole CLI loop over an in-memory input, the output goes to an in-memory stream too.
+ */
+static void run_cli_queries(benchmark::State &state, bool binary) {
+    const auto n = static_cast<std::size_t>(state.range(0));
+    const auto engine = static_cast<StorageEngine>(state.range(1));
+    const auto queries = binary ? generate_binary_queries(n) : generate_queries(n);
+    const CliOptions options{.engine = engine, .binary = binary};
+    const auto old_input = std::cin.rdbuf();
+    const auto old_output = std::cout.rdbuf();
+    for (auto _: state) {
+        state.PauseTiming();
+        std::istringstream input(queries);
+        std::ostringstream output;
+        std::cin.rdbuf(input.rdbuf());
+        std::cout.rdbuf(output.rdbuf());
+        state.ResumeTiming();
+        run(options);
+        state.PauseTiming();
+        std::cin.rdbuf(old_input);
+        std::cout.rdbuf(old_output);
+        std::cin.clear();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * 2 * n));
+    state.SetLabel(engine == StorageEngine::B_PLUS_TREE ? "b-plus-tree" : "rb-tree");
+}
+
+static void cli_queries(benchmark::State &state) {
+    run_cli_queries(state, false);
+}
+
+static void cli_binary_queries(benchmark::State &state) {
+    run_cli_queries(state, true);
+}
+
+static void sizes_and_engines(benchmark::internal::Benchmark *benchmark) {
+    for (const auto engine: {StorageEngine::RED_BLACK_TREE, StorageEngine::B_PLUS_TREE}) {
+        for (long n = 1'000; n <= 1'000'000; n *= 10)
+            benchmark->Args({n, static_cast<long>(engine)});
+    }
+}
+
+BENCHMARK(cli_queries)->Apply(sizes_and_engines)->Unit(benchmark::kMillisecond);
+BENCHMARK(cli_binary_queries)->Apply(sizes_and_engines)->Unit(benchmark::kMillisecond);
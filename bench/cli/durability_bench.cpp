@@ -0,0 +1,94 @@
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+#include "KeyStorage.h"
+#include "Workloads.h"
+
+/**
+ * Costs of the write-ahead log of KeyStorage: insert throughput for several fsync batch sizes
+ * and the recovery time of a directory with or without a checkpoint.
+ */
+
+static constexpr std::size_t INGEST_KEYS = 1 << 16;
+
+static std::filesystem::path bench_directory() {
+    return std::filesystem::temp_directory_path() / "order_statistic_tree_durability_bench";
+}
+
+static DurabilityOptions durability_options(std::size_t sync_every) {
+    DurabilityOptions durability;
+    durability.directory = bench_directory();
+    durability.sync_every = sync_every;
+    durability.checkpoint_interval = std::chrono::milliseconds(0);
+    return durability;
+}
+
+/**
+ * range(0) is DurabilityOptions::sync_every, -1 is the storage without a log.
+ */
+static void durable_ingest(benchmark::State &state) {
+    const auto keys = random_keys(INGEST_KEYS);
+    for (auto _: state) {
+        state.PauseTiming();
+        std::filesystem::remove_all(bench_directory());
+        std::unique_ptr<KeyStorage> storage;
+        if (state.range(0) < 0)
+            storage = std::make_unique<KeyStorage>();
+        else
+            storage = std::make_unique<KeyStorage>(StorageEngine::RED_BLACK_TREE,
+                                                   durability_options(static_cast<std::size_t>(state.range(0))));
+        state.ResumeTiming();
+        for (const auto key: keys)
+            storage->try_insert_key(key);
+        if (const auto log = storage->write_ahead_log())
+            log->sync();
+        state.PauseTiming();
+        storage.reset();
+        state.ResumeTiming();
+    }
+    std::filesystem::remove_all(bench_directory());
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * INGEST_KEYS));
+    state.SetLabel(state.range(0) < 0 ? "no log" : "sync every " + std::to_string(state.range(0)));
+}
+
+/**
+ * A directory with range(0) inserted keys and range(1) more inserts in the log tail.
+ * With range(2) = 1 the first keys are in a checkpoint, otherwise the whole history is replayed.
+ */
+static void recovery(benchmark::State &state) {
+    const auto n = static_cast<std::size_t>(state.range(0));
+    const auto tail = static_cast<std::size_t>(state.range(1));
+    const bool checkpointed = state.range(2) == 1;
+    const auto keys = random_keys(n + tail);
+    std::filesystem::remove_all(bench_directory());
+    {
+        KeyStorage storage(StorageEngine::RED_BLACK_TREE, durability_options(0));
+        for (std::size_t i = 0; i < n; i++)
+            storage.try_insert_key(keys[i]);
+        if (checkpointed)
+            storage.write_ahead_log()->checkpoint();
+        for (std::size_t i = n; i < n + tail; i++)
+            storage.try_insert_key(keys[i]);
+    }
+    for (auto _: state) {
+        KeyStorage storage(StorageEngine::RED_BLACK_TREE, durability_options(0));
+        benchmark::DoNotOptimize(storage.get_less_count(0));
+        state.PauseTiming();
+        // Every opening starts an empty segment, drop it so the iterations see the same directory.
+        storage = KeyStorage();
+        for (const auto &entry: std::filesystem::directory_iterator(bench_directory())) {
+            if (std::filesystem::file_size(entry.path()) == 0)
+                std::filesystem::remove(entry.path());
+        }
+        state.ResumeTiming();
+    }
+    std::filesystem::remove_all(bench_directory());
+    state.SetLabel(checkpointed ? "checkpoint + tail" : "log replay");
+}
+
+BENCHMARK(durable_ingest)->Arg(-1)->Arg(0)->Arg(4096)->Arg(256)->Arg(16)->Arg(1)
+        ->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(recovery)->ArgsProduct({{1'000'000}, {10'000}, {0, 1}})->Unit(benchmark::kMillisecond);
@@ -0,0 +1,250 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "KeyStorage.h"
+#include "QueryExecutor.h"
+#include "Workloads.h"
+
+/**
+ * Per-query overhead of QueryExecutor on a small tree, so the tree operations are cheap:
+ * the response appended to a reused buffer against a returned string, and against ThrowingQueryExecutor,
+ * the executor before the queries became plain structs.
+ * allocations_per_query counts the calls of operator new of the whole program.
+ */
+
+static std::atomic<std::size_t> allocation_count = 0;
+
+/**
+ * The replacements are kept out of line: a delete inlined next to the call of operator new
+ * would show GCC free() on a pointer from new (-Wmismatched-new-delete).
+ */
+[[gnu::noinline]] void *operator new(std::size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void *memory = std::malloc(size == 0 ? 1 : size))
+        return memory;
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+
+[[gnu::noinline]] void operator delete(void *memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+/**
+ * Baseline copy of the former executor: a query is looked up by name in a map of factories, allocated
+ * on the heap and executed by a virtual call, parse and storage errors are thrown and caught.
+ */
+class ThrowingQueryExecutor {
+public:
+    explicit ThrowingQueryExecutor(KeyStorage &storage) {
+        query_names["m"] = [&storage](std::string_view args) -> std::unique_ptr<Query> {
+            return std::make_unique<FindOrderStatistic>(storage, args);
+        };
+        query_names["n"] = [&storage](std::string_view args) -> std::unique_ptr<Query> {
+            return std::make_unique<GetLessCount>(storage, args);
+        };
+        query_names["k"] = [&storage](std::string_view args) -> std::unique_ptr<Query> {
+            return std::make_unique<InsertKey>(storage, args);
+        };
+        query_names["d"] = [&storage](std::string_view args) -> std::unique_ptr<Query> {
+            return std::make_unique<EraseKey>(storage, args);
+        };
+    }
+
+    std::string execute_query(std::string_view query) {
+        try {
+            return parse_query(query)->execute();
+        } catch (const std::exception &ex) {
+            return ex.what();
+        }
+    }
+
+private:
+    class Query {
+    public:
+        explicit Query(KeyStorage &storage) : storage(storage) {}
+
+        virtual ~Query() = default;
+
+        virtual std::string execute() = 0;
+
+    protected:
+        KeyStorage &storage;
+    };
+
+    class InsertKey : public Query {
+    public:
+        InsertKey(KeyStorage &storage, std::string_view args) : Query(storage), key(parse_integer<int>(args)) {}
+
+        std::string execute() override {
+            try {
+                storage.insert_key(key);
+                return "Successfully added.";
+            } catch (const std::exception &ex) {
+                return ex.what();
+            }
+        }
+
+    private:
+        int key;
+    };
+
+    class EraseKey : public Query {
+    public:
+        EraseKey(KeyStorage &storage, std::string_view args) : Query(storage), key(parse_integer<int>(args)) {}
+
+        std::string execute() override {
+            try {
+                storage.erase_key(key);
+                return "Successfully deleted.";
+            } catch (const std::exception &ex) {
+                return ex.what();
+            }
+        }
+
+    private:
+        int key;
+    };
+
+    class FindOrderStatistic : public Query {
+    public:
+        FindOrderStatistic(KeyStorage &storage, std::string_view args) :
+                Query(storage), k(parse_integer<ssize_t>(args)) {}
+
+        std::string execute() override {
+            try {
+                return std::to_string(storage.find_order_statistic(static_cast<std::size_t>(k)));
+            } catch (const std::exception &ex) {
+                return ex.what();
+            }
+        }
+
+    private:
+        ssize_t k;
+    };
+
+    class GetLessCount : public Query {
+    public:
+        GetLessCount(KeyStorage &storage, std::string_view args) : Query(storage), key(parse_integer<int>(args)) {}
+
+        std::string execute() override {
+            return std::to_string(storage.get_less_count(key));
+        }
+
+    private:
+        int key;
+    };
+
+    /** Lets the query names be looked up by string_view. */
+    struct NameHash {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view name) const {
+            return std::hash<std::string_view>()(name);
+        }
+    };
+
+    std::unordered_map<
+            std::string,
+            std::function<std::unique_ptr<Query>(std::string_view)>,
+            NameHash,
+            std::equal_to<>
+    > query_names;
+
+    template<class Integer>
+    static Integer parse_integer(std::string_view args) {
+        Integer value = 0;
+        if (!parse_integer_argument(args, value))
+            throw std::invalid_argument("Expected integer argument.");
+        return value;
+    }
+
+    static std::string_view next_token(std::string_view &line) {
+        constexpr std::string_view whitespace = " \t\n\v\f\r";
+        const auto first = std::min(line.find_first_not_of(whitespace), line.size());
+        const auto last = std::min(line.find_first_of(whitespace, first), line.size());
+        const auto token = line.substr(first, last - first);
+        line.remove_prefix(last);
+        return token;
+    }
+
+    [[nodiscard]] std::unique_ptr<Query> parse_query(std::string_view query_str) const {
+        const auto name = next_token(query_str);
+        const auto args = next_token(query_str);
+        const auto query_constructor = query_names.find(name);
+        if (query_constructor == query_names.end())
+            throw std::invalid_argument("Unknown query.");
+        return query_constructor->second(args);
+    }
+};
+
+static constexpr std::size_t TREE_SIZE = 1 << 10;
+static constexpr std::size_t QUERY_COUNT = 1 << 12;
+
+/**
+ * Rank queries with some errors and insertions of existing keys, so the tree doesn't change.
+ */
+static std::vector<std::string> generate_lines() {
+    const auto keys = random_keys(QUERY_COUNT, 7);
+    std::vector<std::string> lines;
+    for (std::size_t i = 0; i < QUERY_COUNT; i++) {
+        const auto key = std::to_string(keys[i] % static_cast<int>(TREE_SIZE));
+        switch (i % 4) {
+            case 0:
+                lines.push_back("n " + key);
+                break;
+            case 1:
+                lines.push_back("m " + std::to_string(i % (TREE_SIZE + 1)));
+                break;
+            case 2:
+                lines.push_back("k " + std::to_string(i % TREE_SIZE));
+                break;
+            default:
+                lines.push_back(i % 8 == 3 ? "x " + key : "n abc");
+        }
+    }
+    return lines;
+}
+
+static void execute_queries(benchmark::State &state) {
+    KeyStorage storage;
+    for (std::size_t key = 0; key < TREE_SIZE; key++)
+        storage.insert_key(static_cast<int>(key));
+    QueryExecutor executor(storage);
+    ThrowingQueryExecutor throwing_executor(storage);
+    const auto lines = generate_lines();
+    const auto mode = state.range(0);
+    std::string response;
+    std::size_t i = 0;
+    const auto allocations_before = allocation_count.load();
+    for (auto _: state) {
+        const auto &line = lines[i++ % QUERY_COUNT];
+        if (mode == 0) {
+            response.clear();
+            executor.execute_query(line, response);
+            benchmark::DoNotOptimize(response.data());
+        } else if (mode == 1) {
+            benchmark::DoNotOptimize(executor.execute_query(line));
+        } else {
+            benchmark::DoNotOptimize(throwing_executor.execute_query(line));
+        }
+    }
+    state.counters["allocations_per_query"] = benchmark::Counter(
+            static_cast<double>(allocation_count.load() - allocations_before), benchmark::Counter::kAvgIterations);
+    state.SetLabel(mode == 0 ? "output buffer" : mode == 1 ? "returned strings" : "throwing executor");
+}
+
+BENCHMARK(execute_queries)->Arg(0)->Arg(1)->Arg(2);
@@ -0,0 +1,75 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+
+#include "KeyStorage.h"
+#include "ShardedKeyStorage.h"
+#include "Workloads.h"
+
+/**
+ * Insert throughput of several threads: every thread inserts its own random keys.
+ * KeyStorage behind one mutex is the baseline, ShardedKeyStorage takes a lock per shard.
+ */
+
+static constexpr std::size_t KEYS_PER_THREAD = 1 << 16;
+
+class LockedKeyStorage {
+public:
+    void insert_key(int key) {
+        std::lock_guard lock(mutex);
+        storage.insert_key(key);
+    }
+
+private:
+    KeyStorage storage;
+    std::mutex mutex;
+};
+
+static std::unique_ptr<LockedKeyStorage> locked_storage;
+static std::unique_ptr<ShardedKeyStorage> sharded_storage;
+
+template<class Storage>
+static std::unique_ptr<Storage> &shared_storage() {
+    if constexpr (std::is_same_v<Storage, ShardedKeyStorage>)
+        return sharded_storage;
+    else
+        return locked_storage;
+}
+
+template<class Storage>
+static void create_storage(const benchmark::State &) {
+    shared_storage<Storage>() = std::make_unique<Storage>();
+}
+
+template<class Storage>
+static void destroy_storage(const benchmark::State &) {
+    shared_storage<Storage>().reset();
+}
+
+/**
+ * One iteration per thread: the storage is created once per run, before the threads start.
+ */
+template<class Storage>
+static void concurrent_inserts(benchmark::State &state) {
+    // Distinct seeds give distinct keys with a negligible number of collisions, they are skipped.
+    const auto keys = random_keys(KEYS_PER_THREAD, 42 + state.thread_index());
+    auto &storage = *shared_storage<Storage>();
+    for (auto _: state) {
+        for (const auto key: keys) {
+            try {
+                storage.insert_key(key);
+            } catch (const std::invalid_argument &) {
+            }
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * KEYS_PER_THREAD));
+}
+
+BENCHMARK_TEMPLATE(concurrent_inserts, LockedKeyStorage)
+        ->Setup(create_storage<LockedKeyStorage>)->Teardown(destroy_storage<LockedKeyStorage>)
+        ->Iterations(1)->ThreadRange(1, 16)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(concurrent_inserts, ShardedKeyStorage)
+        ->Setup(create_storage<ShardedKeyStorage>)->Teardown(destroy_storage<ShardedKeyStorage>)
+        ->Iterations(1)->ThreadRange(1, 16)->UseRealTime()->Unit(benchmark::kMillisecond);
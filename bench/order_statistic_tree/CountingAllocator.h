@@ -0,0 +1,36 @@
+#ifndef ORDER_STATISTIC_TREE_COUNTINGALLOCATOR_H
+#define ORDER_STATISTIC_TREE_COUNTINGALLOCATOR_H
+
+#include <cstddef>
+#include <memory>
+
+/**
+ * Heap allocator that tracks the number of live bytes of all its instantiations.
+ */
+inline std::size_t counted_bytes = 0;
+
+template<class T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() = default;
+
+    template<class U>
+    CountingAllocator(const CountingAllocator<U> &) noexcept {}
+
+    T *allocate(std::size_t n) {
+        counted_bytes += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T *ptr, std::size_t n) noexcept {
+        counted_bytes -= n * sizeof(T);
+        std::allocator<T>().deallocate(ptr, n);
+    }
+
+    friend bool operator==(const CountingAllocator &, const CountingAllocator &) {
+        return true;
+    }
+};
+
+#endif //ORDER_STATISTIC_TREE_COUNTINGALLOCATOR_H
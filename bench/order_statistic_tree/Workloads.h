@@ -0,0 +1,143 @@
+#ifndef ORDER_STATISTIC_TREE_WORKLOADS_H
+#define ORDER_STATISTIC_TREE_WORKLOADS_H
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * Key generators shared by the benchmarks. All of them are deterministic for a given seed.
+ */
+
+enum class KeyOrder {
+    SEQUENTIAL,
+    RANDOM,
+    ZIPFIAN
+};
+
+inline std::string key_order_name(KeyOrder order) {
+    switch (order) {
+        case KeyOrder::SEQUENTIAL:
+            return "sequential";
+        case KeyOrder::RANDOM:
+            return "random";
+        case KeyOrder::ZIPFIAN:
+            return "zipfian";
+    }
+    return "unknown";
+}
+
+/**
+ * Keys 0, 1, ..., n - 1.
+ */
+inline std::vector<int> sequential_keys(std::size_t n) {
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+    return keys;
+}
+
+/**
+ * Uniform keys from the whole int range.
+ */
+inline std::vector<int> random_keys(std::size_t n, std::uint32_t seed = 42) {
+    std::mt19937 engine(seed);
+    std::uniform_int_distribution<int> uniform_dist(INT_MIN, INT_MAX);
+    std::vector<int> keys(n);
+    for (auto &key: keys)
+        key = uniform_dist(engine);
+    return keys;
+}
+
+/**
+ * Zipfian ranks from 0 to universe - 1: the rank i is drawn with probability proportional to 1 / (i + 1)^skew.
+ * Uses the method of Gray et al. "Quickly generating billion-record synthetic databases",
+ * the normalization constant takes O(universe) once.
+ */
+class ZipfianGenerator {
+public:
+    explicit ZipfianGenerator(std::size_t universe, double skew = 0.99, std::uint32_t seed = 42) :
+            universe(static_cast<double>(universe)), engine(seed) {
+        for (std::size_t i = 1; i <= universe; i++)
+            zeta += 1 / std::pow(static_cast<double>(i), skew);
+        const double zeta_two = 1 + 1 / std::pow(2.0, skew);
+        alpha = 1 / (1 - skew);
+        eta = (1 - std::pow(2 / this->universe, 1 - skew)) / (1 - zeta_two / zeta);
+        half_pow_skew = 1 + std::pow(0.5, skew);
+    }
+
+    std::size_t operator()() {
+        const double u = uniform_dist(engine);
+        const double uz = u * zeta;
+        if (uz < 1)
+            return 0;
+        if (uz < half_pow_skew)
+            return 1;
+        const auto rank = static_cast<std::size_t>(universe * std::pow(eta * u - eta + 1, alpha));
+        return std::min(rank, static_cast<std::size_t>(universe) - 1);
+    }
+
+private:
+    double universe;
+    double zeta = 0;
+    double alpha = 0;
+    double eta = 0;
+    double half_pow_skew = 0;
+    std::mt19937_64 engine;
+    std::uniform_real_distribution<double> uniform_dist{0, 1};
+};
+
+/**
+ * count Zipfian keys over universe distinct values. Popular ranks are scattered over the int range
+ * by a multiplicative hash, so hot keys don't sit next to each other in the tree.
+ */
+inline std::vector<int> zipfian_keys(std::size_t count, std::size_t universe, std::uint32_t seed = 42) {
+    ZipfianGenerator generator(universe, 0.99, seed);
+    std::vector<int> keys(count);
+    for (auto &key: keys)
+        key = static_cast<int>(static_cast<std::uint32_t>(generator()) * 2654435761u);
+    return keys;
+}
+
+/**
+ * n keys to fill a tree.
+ */
+inline std::vector<int> generate_keys(KeyOrder order, std::size_t n, std::uint32_t seed = 42) {
+    switch (order) {
+        case KeyOrder::SEQUENTIAL:
+            return sequential_keys(n);
+        case KeyOrder::RANDOM:
+            return random_keys(n, seed);
+        case KeyOrder::ZIPFIAN:
+            return zipfian_keys(n, n, seed);
+    }
+    return {};
+}
+
+/**
+ * count keys to query a tree filled by generate_keys(order, n): uniform over the sequential keys,
+ * uniform over the int range for random keys and with the same skew for Zipfian keys.
+ */
+inline std::vector<int> query_keys(KeyOrder order, std::size_t n, std::size_t count, std::uint32_t seed = 7) {
+    switch (order) {
+        case KeyOrder::SEQUENTIAL: {
+            std::mt19937 engine(seed);
+            std::uniform_int_distribution<int> uniform_dist(0, static_cast<int>(n) - 1);
+            std::vector<int> keys(count);
+            for (auto &key: keys)
+                key = uniform_dist(engine);
+            return keys;
+        }
+        case KeyOrder::RANDOM:
+            return random_keys(count, seed);
+        case KeyOrder::ZIPFIAN:
+            return zipfian_keys(count, n, seed);
+    }
+    return {};
+}
+
+#endif //ORDER_STATISTIC_TREE_WORKLOADS_H
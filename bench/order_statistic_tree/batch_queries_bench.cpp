@@ -0,0 +1,84 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "OrderStatisticTree.h"
+#include "Workloads.h"
+
+/**
+ * Batches of BATCH_SIZE random queries: one call per query against one batch call.
+ * The tree is filled by random insertions, so the nodes are scattered over the heap
+ * as in a long-living tree. Items per second is the number of queries.
+ */
+
+static constexpr std::size_t BATCH_SIZE = 1 << 12;
+
+static std::unique_ptr<OrderStatisticTree> random_tree;
+
+static const OrderStatisticTree &cached_random_tree(std::size_t n) {
+    if (!random_tree || random_tree->size() != n) {
+        random_tree.reset();
+        random_tree = std::make_unique<OrderStatisticTree>();
+        auto keys = random_keys(n);
+        // Duplicates are replaced, so the tree has exactly n keys.
+        for (std::size_t i = 0; random_tree->size() < n; i++)
+            random_tree->insert(i < n ? keys[i] : static_cast<int>(i));
+    }
+    return *random_tree;
+}
+
+static std::vector<std::size_t> random_ranks(std::size_t n) {
+    std::mt19937 engine(7);
+    std::uniform_int_distribution<std::size_t> rank_dist(1, n);
+    std::vector<std::size_t> ranks(BATCH_SIZE);
+    for (auto &k: ranks)
+        k = rank_dist(engine);
+    return ranks;
+}
+
+static void less_count_queries(benchmark::State &state) {
+    const auto &tree = cached_random_tree(static_cast<std::size_t>(state.range(0)));
+    const auto keys = random_keys(BATCH_SIZE, 7);
+    std::vector<std::size_t> counts(BATCH_SIZE);
+    const bool batched = state.range(1) != 0;
+    for (auto _: state) {
+        if (batched) {
+            tree.less_count_batch(keys, counts);
+        } else {
+            for (std::size_t i = 0; i < BATCH_SIZE; i++)
+                counts[i] = tree.less_count(keys[i]);
+        }
+        benchmark::DoNotOptimize(counts.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * BATCH_SIZE));
+    state.SetLabel(batched ? "batch" : "one by one");
+}
+
+static void find_order_statistic_queries(benchmark::State &state) {
+    const auto &tree = cached_random_tree(static_cast<std::size_t>(state.range(0)));
+    const auto ranks = random_ranks(tree.size());
+    std::vector<int> keys(BATCH_SIZE);
+    const bool batched = state.range(1) != 0;
+    for (auto _: state) {
+        if (batched) {
+            tree.find_order_statistic_batch(ranks, keys);
+        } else {
+            for (std::size_t i = 0; i < BATCH_SIZE; i++)
+                keys[i] = tree.find_order_statistic(ranks[i]);
+        }
+        benchmark::DoNotOptimize(keys.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * BATCH_SIZE));
+    state.SetLabel(batched ? "batch" : "one by one");
+}
+
+static void sizes_and_modes(benchmark::internal::Benchmark *benchmark) {
+    for (long n = 10'000; n <= 10'000'000; n *= 10) {
+        for (const long batched: {0, 1})
+            benchmark->Args({n, batched});
+    }
+}
+
+BENCHMARK(less_count_queries)->Apply(sizes_and_modes);
+BENCHMARK(find_order_statistic_queries)->Apply(sizes_and_modes);
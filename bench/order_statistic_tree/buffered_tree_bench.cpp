@@ -0,0 +1,75 @@
+#include <benchmark/benchmark.h>
+#include <vector>
+
+#include "BufferedOrderStatisticTree.h"
+#include "OrderStatisticTree.h"
+#include "Workloads.h"
+
+/**
+ * Ingest of n random keys: single inserts into the tree against the write buffer with bulk merges,
+ * inserts interleaved with rank queries, and the rank queries after the ingest, which also search
+ * the part of the buffer left unmerged.
+ */
+
+static void tree_ingest(benchmark::State &state) {
+    const auto keys = random_keys(static_cast<std::size_t>(state.range(0)));
+    for (auto _: state) {
+        OrderStatisticTree tree;
+        for (const auto key: keys)
+            tree.insert(key);
+        benchmark::DoNotOptimize(tree.size());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * keys.size()));
+}
+
+static void buffered_ingest(benchmark::State &state) {
+    const auto keys = random_keys(static_cast<std::size_t>(state.range(0)));
+    for (auto _: state) {
+        BufferedOrderStatisticTree<> tree;
+        for (const auto key: keys)
+            tree.insert(key);
+        tree.flush();
+        benchmark::DoNotOptimize(tree.main_tree().size());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * keys.size()));
+}
+
+/**
+ * range(1) inserts between two rank queries.
+ */
+static void buffered_mixed(benchmark::State &state) {
+    const auto keys = random_keys(static_cast<std::size_t>(state.range(0)));
+    const auto inserts_per_query = static_cast<std::size_t>(state.range(1));
+    for (auto _: state) {
+        BufferedOrderStatisticTree<> tree;
+        for (std::size_t i = 0; i < keys.size(); i++) {
+            tree.insert(keys[i]);
+            if (i % inserts_per_query == 0)
+                benchmark::DoNotOptimize(tree.less_count(keys[i / 2]));
+        }
+        benchmark::DoNotOptimize(tree.size());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * keys.size()));
+}
+
+static void buffered_less_count(benchmark::State &state) {
+    const auto n = static_cast<std::size_t>(state.range(0));
+    const auto keys = random_keys(n);
+    BufferedOrderStatisticTree<> tree;
+    for (const auto key: keys)
+        tree.insert(key);
+    // The first query sorts the buffer into the run, the measured ones search the tree and the run.
+    benchmark::DoNotOptimize(tree.less_count(0));
+    const auto queries = random_keys(1 << 16, 7);
+    std::size_t i = 0;
+    for (auto _: state) {
+        benchmark::DoNotOptimize(tree.less_count(queries[i]));
+        i = (i + 1) % queries.size();
+    }
+    state.SetLabel(std::to_string(tree.buffered_count()) + " keys in the run");
+}
+
+BENCHMARK(tree_ingest)->RangeMultiplier(10)->Range(100'000, 10'000'000)->Unit(benchmark::kMillisecond);
+BENCHMARK(buffered_ingest)->RangeMultiplier(10)->Range(100'000, 10'000'000)->Unit(benchmark::kMillisecond);
+BENCHMARK(buffered_mixed)->ArgsProduct({{1'000'000}, {16, 256, 4096}})->Unit(benchmark::kMillisecond);
+BENCHMARK(buffered_less_count)->Arg(1'000'000)->Arg(10'000'000);
@@ -0,0 +1,61 @@
+#include <benchmark/benchmark.h>
+#include <numeric>
+#include <vector>
+
+#include "NodeArena.h"
+#include "OrderStatisticTree.h"
+#include "Workloads.h"
+
+using ArenaOrderStatisticTree = BasicOrderStatisticTree<int, std::less<int>, NoAugmentation, NodeArena<int>>;
+
+template<class Tree>
+static void load_sorted_by_insert(benchmark::State &state) {
+    std::vector<int> keys(state.range(0));
+    std::iota(keys.begin(), keys.end(), 0);
+    for (auto _: state) {
+        Tree tree;
+        for (const auto key: keys)
+            tree.insert(key);
+        benchmark::DoNotOptimize(tree.size());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * keys.size()));
+}
+
+template<class Tree>
+static void load_sorted_by_build(benchmark::State &state) {
+    std::vector<int> keys(state.range(0));
+    std::iota(keys.begin(), keys.end(), 0);
+    for (auto _: state) {
+        auto tree = Tree::build_from_sorted(keys);
+        benchmark::DoNotOptimize(tree.size());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * keys.size()));
+}
+
+template<class Tree>
+static void load_random_by_insert(benchmark::State &state) {
+    const auto keys = random_keys(state.range(0));
+    for (auto _: state) {
+        Tree tree;
+        for (const auto key: keys)
+            tree.insert(key);
+        benchmark::DoNotOptimize(tree.size());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * keys.size()));
+}
+
+template<class Tree>
+static void load_random_by_bulk_insert(benchmark::State &state) {
+    const auto keys = random_keys(state.range(0));
+    for (auto _: state) {
+        Tree tree;
+        tree.bulk_insert(keys);
+        benchmark::DoNotOptimize(tree.size());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * keys.size()));
+}
+
+BENCHMARK_TEMPLATE(load_sorted_by_insert, ArenaOrderStatisticTree)->Range(1 << 12, 1 << 22)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(load_sorted_by_build, ArenaOrderStatisticTree)->Range(1 << 12, 1 << 22)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(load_random_by_insert, ArenaOrderStatisticTree)->Range(1 << 12, 1 << 22)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(load_random_by_bulk_insert, ArenaOrderStatisticTree)->Range(1 << 12, 1 << 22)->Unit(benchmark::kMillisecond);
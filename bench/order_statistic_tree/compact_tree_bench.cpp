@@ -0,0 +1,74 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "CompactOrderStatisticTree.h"
+#include "CountingAllocator.h"
+#include "OrderStatisticTree.h"
+
+using CountedOrderStatisticTree = BasicOrderStatisticTree<int, std::less<int>, NoAugmentation, CountingAllocator<int>>;
+
+template<class Tree>
+static std::size_t memory_usage(const Tree &) {
+    return counted_bytes;
+}
+
+static std::size_t memory_usage(const CompactOrderStatisticTree &tree) {
+    return tree.memory_usage();
+}
+
+/**
+ * Builds a tree of n even keys inserted in random order. The last built tree is kept,
+ * so the query benchmarks of one size share it.
+ */
+template<class Tree>
+static const Tree &cached_tree(std::size_t n) {
+    static std::optional<Tree> tree;
+    static std::size_t tree_size = 0;
+    if (!tree || tree_size != n) {
+        tree.reset();
+        std::vector<int> keys(n);
+        std::iota(keys.begin(), keys.end(), 0);
+        std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+        tree.emplace();
+        for (const auto key: keys)
+            tree->insert(key * 2);
+        tree_size = n;
+    }
+    return *tree;
+}
+
+template<class Tree>
+static void less_count_latency(benchmark::State &state) {
+    const auto n = static_cast<std::size_t>(state.range(0));
+    const auto &tree = cached_tree<Tree>(n);
+    std::mt19937 engine(1);
+    std::uniform_int_distribution<int> key_dist(0, static_cast<int>(2 * n));
+    for (auto _: state)
+        benchmark::DoNotOptimize(tree.less_count(key_dist(engine)));
+    state.counters["bytes_per_key"] = static_cast<double>(memory_usage(tree)) / static_cast<double>(n);
+}
+
+template<class Tree>
+static void find_order_statistic_latency(benchmark::State &state) {
+    const auto n = static_cast<std::size_t>(state.range(0));
+    const auto &tree = cached_tree<Tree>(n);
+    std::mt19937 engine(1);
+    std::uniform_int_distribution<std::size_t> k_dist(1, n);
+    for (auto _: state)
+        benchmark::DoNotOptimize(tree.find_order_statistic(k_dist(engine)));
+    state.counters["bytes_per_key"] = static_cast<double>(memory_usage(tree)) / static_cast<double>(n);
+}
+
+static void tree_sizes(benchmark::internal::Benchmark *benchmark) {
+    for (const long n: {1'000'000L, 10'000'000L, 100'000'000L})
+        benchmark->Arg(n);
+}
+
+BENCHMARK_TEMPLATE(less_count_latency, CountedOrderStatisticTree)->Apply(tree_sizes);
+BENCHMARK_TEMPLATE(less_count_latency, CompactOrderStatisticTree)->Apply(tree_sizes);
+BENCHMARK_TEMPLATE(find_order_statistic_latency, CountedOrderStatisticTree)->Apply(tree_sizes);
+BENCHMARK_TEMPLATE(find_order_statistic_latency, CompactOrderStatisticTree)->Apply(tree_sizes);
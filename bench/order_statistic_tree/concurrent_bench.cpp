@@ -0,0 +1,92 @@
+#include <benchmark/benchmark.h>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+#include "ConcurrentOrderStatisticTree.h"
+#include "OrderStatisticTree.h"
+#include "Workloads.h"
+
+/**
+ * The straightforward alternative: one tree behind a reader-writer lock.
+ */
+class SharedMutexOrderStatisticTree {
+public:
+    [[nodiscard]] std::size_t less_count(int key) const {
+        std::shared_lock lock(mutex);
+        return tree.less_count(key);
+    }
+
+    bool insert(int key) {
+        std::unique_lock lock(mutex);
+        return tree.insert(key).second;
+    }
+
+    std::size_t erase(int key) {
+        std::unique_lock lock(mutex);
+        return tree.erase(key);
+    }
+
+private:
+    OrderStatisticTree tree;
+    mutable std::shared_mutex mutex;
+};
+
+static constexpr std::size_t TREE_SIZE = 1 << 20;
+static constexpr std::size_t QUERY_COUNT = 1 << 16;
+
+template<class Tree>
+static Tree &shared_tree() {
+    static Tree tree;
+    static std::once_flag filled;
+    std::call_once(filled, [] {
+        for (const auto key: random_keys(TREE_SIZE))
+            tree.insert(key);
+    });
+    return tree;
+}
+
+/**
+ * Every thread runs less_count queries, the throughput is summed over the threads.
+ */
+template<class Tree>
+static void concurrent_reads(benchmark::State &state) {
+    const auto &tree = shared_tree<Tree>();
+    const auto keys = random_keys(QUERY_COUNT, 7 + state.thread_index());
+    std::size_t i = 0;
+    for (auto _: state)
+        benchmark::DoNotOptimize(tree.less_count(keys[i++ % QUERY_COUNT]));
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+/**
+ * Thread 0 toggles keys of a pool (insert if absent, erase otherwise) while the others read.
+ * Only the reads are counted.
+ */
+template<class Tree>
+static void reads_with_writer(benchmark::State &state) {
+    auto &tree = shared_tree<Tree>();
+    const auto keys = random_keys(QUERY_COUNT, 7 + state.thread_index());
+    const bool writer = state.thread_index() == 0;
+    std::size_t i = 0;
+    for (auto _: state) {
+        const auto key = keys[i++ % QUERY_COUNT];
+        if (writer) {
+            if (tree.erase(key) == 0)
+                tree.insert(key);
+        } else {
+            benchmark::DoNotOptimize(tree.less_count(key));
+        }
+    }
+    if (writer) {
+        for (const auto key: keys)
+            tree.erase(key);
+    } else {
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    }
+}
+
+BENCHMARK_TEMPLATE(concurrent_reads, ConcurrentOrderStatisticTree<>)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(concurrent_reads, SharedMutexOrderStatisticTree)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(reads_with_writer, ConcurrentOrderStatisticTree<>)->ThreadRange(2, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(reads_with_writer, SharedMutexOrderStatisticTree)->ThreadRange(2, 16)->UseRealTime();
@@ -0,0 +1,101 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "FrozenOrderStatisticTree.h"
+#include "OrderStatisticTree.h"
+#include "Workloads.h"
+
+/**
+ * Rank queries on range(0) random keys: the pointer tree, its frozen Eytzinger copy
+ * and std::lower_bound over the sorted keys as the baseline of a plain binary search.
+ */
+
+static constexpr std::size_t QUERY_COUNT = 1 << 16;
+
+/**
+ * The tree of the last size, so the benchmarks of one size share it.
+ */
+static const OrderStatisticTree &cached_tree(std::size_t n) {
+    static std::unique_ptr<OrderStatisticTree> tree;
+    static std::size_t cached_n = 0;
+    if (!tree || cached_n != n) {
+        tree.reset();
+        auto keys = random_keys(n);
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        tree = std::make_unique<OrderStatisticTree>(OrderStatisticTree::build_from_sorted(keys));
+        cached_n = n;
+    }
+    return *tree;
+}
+
+template<class Index>
+static void less_count_queries(benchmark::State &state, const Index &index) {
+    const auto keys = random_keys(QUERY_COUNT, 7);
+    std::size_t i = 0;
+    for (auto _: state)
+        benchmark::DoNotOptimize(index.less_count(keys[i++ % QUERY_COUNT]));
+}
+
+template<class Index>
+static void find_order_statistic_queries(benchmark::State &state, const Index &index) {
+    std::mt19937 engine(7);
+    std::uniform_int_distribution<std::size_t> k_dist(1, index.size());
+    std::vector<std::size_t> ranks(QUERY_COUNT);
+    for (auto &k: ranks)
+        k = k_dist(engine);
+    std::size_t i = 0;
+    for (auto _: state)
+        benchmark::DoNotOptimize(index.find_order_statistic(ranks[i++ % QUERY_COUNT]));
+}
+
+/**
+ * Sorted keys searched with std::lower_bound.
+ */
+class SortedVectorIndex {
+public:
+    explicit SortedVectorIndex(std::vector<int> keys) : keys(std::move(keys)) {}
+
+    [[nodiscard]] std::size_t less_count(int key) const {
+        return static_cast<std::size_t>(std::lower_bound(keys.begin(), keys.end(), key) - keys.begin());
+    }
+
+private:
+    std::vector<int> keys;
+};
+
+static void tree_less_count(benchmark::State &state) {
+    less_count_queries(state, cached_tree(static_cast<std::size_t>(state.range(0))));
+}
+
+static void frozen_less_count(benchmark::State &state) {
+    less_count_queries(state, freeze(cached_tree(static_cast<std::size_t>(state.range(0)))));
+}
+
+static void sorted_vector_less_count(benchmark::State &state) {
+    less_count_queries(state, SortedVectorIndex(cached_tree(static_cast<std::size_t>(state.range(0))).sorted_keys()));
+}
+
+static void tree_find_order_statistic(benchmark::State &state) {
+    find_order_statistic_queries(state, cached_tree(static_cast<std::size_t>(state.range(0))));
+}
+
+static void frozen_find_order_statistic(benchmark::State &state) {
+    find_order_statistic_queries(state, freeze(cached_tree(static_cast<std::size_t>(state.range(0)))));
+}
+
+static void freeze_tree(benchmark::State &state) {
+    const auto &tree = cached_tree(static_cast<std::size_t>(state.range(0)));
+    for (auto _: state)
+        benchmark::DoNotOptimize(freeze(tree).size());
+}
+
+BENCHMARK(tree_less_count)->RangeMultiplier(10)->Range(1'000, 10'000'000);
+BENCHMARK(frozen_less_count)->RangeMultiplier(10)->Range(1'000, 10'000'000);
+BENCHMARK(sorted_vector_less_count)->RangeMultiplier(10)->Range(1'000, 10'000'000);
+BENCHMARK(tree_find_order_statistic)->RangeMultiplier(10)->Range(1'000, 10'000'000);
+BENCHMARK(frozen_find_order_statistic)->RangeMultiplier(10)->Range(1'000, 10'000'000);
+BENCHMARK(freeze_tree)->RangeMultiplier(10)->Range(1'000, 10'000'000)->Unit(benchmark::kMillisecond);
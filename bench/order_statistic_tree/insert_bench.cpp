@@ -0,0 +1,55 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+
+#include "BPlusOrderStatisticTree.h"
+#include "NodeArena.h"
+#include "OrderStatisticTree.h"
+
+using ArenaOrderStatisticTree = BasicOrderStatisticTree<int, std::less<int>, NoAugmentation, NodeArena<int>>;
+
+/**
+ * Random keys with about 10% of repeats.
+ */
+static std::vector<int> generate_keys_with_repeats(std::size_t n) {
+    std::mt19937 engine(42);
+    std::uniform_int_distribution<int> uniform_dist(0, static_cast<int>(n * 5));
+    std::vector<int> keys(n);
+    for (auto &key: keys)
+        key = uniform_dist(engine);
+    return keys;
+}
+
+/**
+ * The way KeyStorage inserted before insert() reported duplicates: a lookup first.
+ */
+template<class Tree>
+static void insert_after_contains(benchmark::State &state) {
+    const auto keys = generate_keys_with_repeats(state.range(0));
+    for (auto _: state) {
+        Tree tree;
+        for (const auto key: keys) {
+            if (!tree.contains(key))
+                tree.insert(key);
+        }
+        benchmark::DoNotOptimize(tree.size());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * keys.size()));
+}
+
+template<class Tree>
+static void insert_single_pass(benchmark::State &state) {
+    const auto keys = generate_keys_with_repeats(state.range(0));
+    for (auto _: state) {
+        Tree tree;
+        for (const auto key: keys)
+            benchmark::DoNotOptimize(tree.insert(key).second);
+        benchmark::DoNotOptimize(tree.size());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * keys.size()));
+}
+
+BENCHMARK_TEMPLATE(insert_after_contains, ArenaOrderStatisticTree)->Range(1 << 12, 1 << 22)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(insert_single_pass, ArenaOrderStatisticTree)->Range(1 << 12, 1 << 22)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(insert_after_contains, BPlusOrderStatisticTree<>)->Range(1 << 12, 1 << 22)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(insert_single_pass, BPlusOrderStatisticTree<>)->Range(1 << 12, 1 << 22)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,66 @@
+#include <benchmark/benchmark.h>
+#include <vector>
+
+#include "CountingAllocator.h"
+#include "KllSketch.h"
+#include "OrderStatisticTree.h"
+#include "Workloads.h"
+
+/**
+ * The exact tree against the approximate KllSketch with the default k on n random keys:
+ * insert throughput, the memory after the inserts (bytes) and the latency of the rank queries.
+ * Both count their memory with CountingAllocator.
+ */
+
+using CountedTree = BasicOrderStatisticTree<int, std::less<int>, NoAugmentation, CountingAllocator<int>>;
+using CountedSketch = KllSketch<int, std::less<int>, CountingAllocator<int>>;
+
+template<class Structure>
+static Structure fill(const std::vector<int> &keys) {
+    Structure structure;
+    for (const auto key: keys)
+        structure.insert(key);
+    return structure;
+}
+
+template<class Structure>
+static void quantile_ingest(benchmark::State &state) {
+    const auto keys = random_keys(static_cast<std::size_t>(state.range(0)));
+    for (auto _: state) {
+        const auto structure = fill<Structure>(keys);
+        benchmark::DoNotOptimize(structure.size());
+        state.counters["bytes"] = static_cast<double>(counted_bytes);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * keys.size()));
+}
+
+template<class Structure>
+static void quantile_less_count(benchmark::State &state) {
+    const auto structure = fill<Structure>(random_keys(static_cast<std::size_t>(state.range(0))));
+    const auto queries = random_keys(1 << 16, 7);
+    std::size_t i = 0;
+    for (auto _: state) {
+        benchmark::DoNotOptimize(structure.less_count(queries[i]));
+        i = (i + 1) % queries.size();
+    }
+}
+
+template<class Structure>
+static void quantile_find_order_statistic(benchmark::State &state) {
+    auto structure = fill<Structure>(random_keys(static_cast<std::size_t>(state.range(0))));
+    // The tree drops the repeated keys, the sketch counts them.
+    const auto n = structure.size();
+    const auto ranks = random_keys(1 << 16, 7);
+    std::size_t i = 0;
+    for (auto _: state) {
+        benchmark::DoNotOptimize(structure.find_order_statistic(static_cast<unsigned>(ranks[i]) % n + 1));
+        i = (i + 1) % ranks.size();
+    }
+}
+
+BENCHMARK_TEMPLATE(quantile_ingest, CountedTree)->Arg(1'000'000)->Arg(10'000'000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(quantile_ingest, CountedSketch)->Arg(1'000'000)->Arg(10'000'000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(quantile_less_count, CountedTree)->Arg(1'000'000)->Arg(10'000'000);
+BENCHMARK_TEMPLATE(quantile_less_count, CountedSketch)->Arg(1'000'000)->Arg(10'000'000);
+BENCHMARK_TEMPLATE(quantile_find_order_statistic, CountedTree)->Arg(1'000'000)->Arg(10'000'000);
+BENCHMARK_TEMPLATE(quantile_find_order_statistic, CountedSketch)->Arg(1'000'000)->Arg(10'000'000);
@@ -0,0 +1,43 @@
+#include <benchmark/benchmark.h>
+#include <optional>
+#include <vector>
+
+#include "NodeArena.h"
+#include "OrderStatisticTree.h"
+#include "Workloads.h"
+
+using ArenaOrderStatisticTree = BasicOrderStatisticTree<int, std::less<int>, NoAugmentation, NodeArena<int>>;
+
+template<class Tree>
+static void insert_random_keys(benchmark::State &state) {
+    const auto keys = random_keys(state.range(0));
+    for (auto _: state) {
+        Tree tree;
+        for (const auto key: keys)
+            tree.insert(key);
+        benchmark::DoNotOptimize(tree.size());
+        state.PauseTiming();
+        tree.clear();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * keys.size()));
+}
+
+template<class Tree>
+static void destroy_tree(benchmark::State &state) {
+    const auto keys = random_keys(state.range(0));
+    for (auto _: state) {
+        state.PauseTiming();
+        std::optional<Tree> tree(std::in_place);
+        for (const auto key: keys)
+            tree->insert(key);
+        state.ResumeTiming();
+        tree.reset();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * keys.size()));
+}
+
+BENCHMARK_TEMPLATE(insert_random_keys, OrderStatisticTree)->Range(1 << 10, 1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(insert_random_keys, ArenaOrderStatisticTree)->Range(1 << 10, 1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(destroy_tree, OrderStatisticTree)->Range(1 << 10, 1 << 20)->Iterations(10)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(destroy_tree, ArenaOrderStatisticTree)->Range(1 << 10, 1 << 20)->Iterations(10)->Unit(benchmark::kMillisecond);
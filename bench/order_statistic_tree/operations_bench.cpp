@@ -0,0 +1,179 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "BPlusOrderStatisticTree.h"
+#include "CountingAllocator.h"
+#include "OrderStatisticTree.h"
+#include "Workloads.h"
+
+/**
+ * Baseline of the tree operations over sequential, random and Zipfian keys.
+ *
+ * Query benchmarks run one operation per iteration, so the reported time is ns/op.
+ * Load benchmarks report ns/op as the time_per_key counter, in seconds with an SI prefix.
+ * bytes_per_key is reported for the red-black tree, whose allocator counts the live bytes.
+ */
+
+using CountedOrderStatisticTree = BasicOrderStatisticTree<int, std::less<int>, NoAugmentation, CountingAllocator<int>>;
+
+static constexpr std::size_t QUERY_COUNT = 1 << 16;
+
+template<class Tree>
+static void set_bytes_per_key(benchmark::State &state, const Tree &tree) {
+    if constexpr (std::is_same_v<Tree, CountedOrderStatisticTree>) {
+        if (!tree.empty())
+            state.counters["bytes_per_key"] = static_cast<double>(counted_bytes) / static_cast<double>(tree.size());
+    }
+}
+
+/**
+ * The last built tree of any type, so a big tree doesn't outlive its benchmarks
+ * and the query benchmarks of one workload share it.
+ */
+struct CachedTree {
+    std::shared_ptr<void> tree;
+    const void *type = nullptr;
+    std::size_t n = 0;
+    KeyOrder order = KeyOrder::SEQUENTIAL;
+};
+
+static CachedTree tree_cache;
+
+template<class Tree>
+static Tree &cached_tree(KeyOrder order, std::size_t n) {
+    static const char type_tag = 0;
+    if (tree_cache.type != &type_tag || tree_cache.n != n || tree_cache.order != order) {
+        tree_cache.tree.reset();
+        auto tree = std::make_shared<Tree>();
+        for (const auto key: generate_keys(order, n))
+            tree->insert(key);
+        tree_cache = CachedTree{tree, &type_tag, n, order};
+    }
+    return *static_cast<Tree *>(tree_cache.tree.get());
+}
+
+template<class Tree>
+static void load_keys(benchmark::State &state) {
+    const auto n = static_cast<std::size_t>(state.range(0));
+    const auto order = static_cast<KeyOrder>(state.range(1));
+    const auto keys = generate_keys(order, n);
+    state.SetLabel(key_order_name(order));
+    for (auto _: state) {
+        Tree tree;
+        for (const auto key: keys)
+            tree.insert(key);
+        benchmark::DoNotOptimize(tree.size());
+        state.PauseTiming();
+        set_bytes_per_key(state, tree);
+        tree.clear();
+        state.ResumeTiming();
+    }
+    state.counters["time_per_key"] = benchmark::Counter(
+            static_cast<double>(n), benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+
+/**
+ * Queries keys of the same workload as the tree keys, with another seed.
+ */
+template<class Tree, class Query>
+static void run_key_queries(benchmark::State &state, Query query) {
+    const auto n = static_cast<std::size_t>(state.range(0));
+    const auto order = static_cast<KeyOrder>(state.range(1));
+    const auto &tree = cached_tree<Tree>(order, n);
+    const auto keys = query_keys(order, n, QUERY_COUNT);
+    state.SetLabel(key_order_name(order));
+    std::size_t i = 0;
+    for (auto _: state)
+        benchmark::DoNotOptimize(query(tree, keys[i++ % QUERY_COUNT]));
+    set_bytes_per_key(state, tree);
+}
+
+template<class Tree>
+static void contains_keys(benchmark::State &state) {
+    run_key_queries<Tree>(state, [](const Tree &tree, int key) { return tree.contains(key); });
+}
+
+template<class Tree>
+static void less_count_keys(benchmark::State &state) {
+    run_key_queries<Tree>(state, [](const Tree &tree, int key) { return tree.less_count(key); });
+}
+
+template<class Tree>
+static void find_order_statistic_keys(benchmark::State &state) {
+    const auto n = static_cast<std::size_t>(state.range(0));
+    const auto order = static_cast<KeyOrder>(state.range(1));
+    const auto &tree = cached_tree<Tree>(order, n);
+    std::mt19937 engine(7);
+    std::uniform_int_distribution<std::size_t> k_dist(1, tree.size());
+    std::vector<std::size_t> ranks(QUERY_COUNT);
+    for (auto &k: ranks)
+        k = k_dist(engine);
+    state.SetLabel(key_order_name(order));
+    std::size_t i = 0;
+    for (auto _: state)
+        benchmark::DoNotOptimize(tree.find_order_statistic(ranks[i++ % QUERY_COUNT]));
+    set_bytes_per_key(state, tree);
+}
+
+/**
+ * Random keys with range(1) percent of less_count queries. A write toggles a key
+ * from a fixed pool: inserts it if it is absent and erases it otherwise, so the size stays stable.
+ */
+template<class Tree>
+static void mixed_read_write(benchmark::State &state) {
+    const auto n = static_cast<std::size_t>(state.range(0));
+    const auto read_percent = static_cast<int>(state.range(1));
+    auto &tree = cached_tree<Tree>(KeyOrder::RANDOM, n);
+    const auto keys = random_keys(QUERY_COUNT, 7);
+    std::mt19937 engine(7);
+    std::uniform_int_distribution<int> percent_dist(0, 99);
+    std::vector<bool> reads(QUERY_COUNT);
+    for (std::size_t i = 0; i < QUERY_COUNT; i++)
+        reads[i] = percent_dist(engine) < read_percent;
+
+    std::size_t i = 0;
+    for (auto _: state) {
+        const auto j = i++ % QUERY_COUNT;
+        if (reads[j]) {
+            benchmark::DoNotOptimize(tree.less_count(keys[j]));
+        } else if (tree.erase(keys[j]) == 0) {
+            tree.insert(keys[j]);
+        }
+    }
+    for (std::size_t j = 0; j < QUERY_COUNT; j++) {
+        if (!reads[j])
+            tree.erase(keys[j]);
+    }
+    state.SetLabel(std::to_string(read_percent) + "% reads");
+    set_bytes_per_key(state, tree);
+}
+
+static void sizes_and_orders(benchmark::internal::Benchmark *benchmark) {
+    for (const auto order: {KeyOrder::SEQUENTIAL, KeyOrder::RANDOM, KeyOrder::ZIPFIAN}) {
+        for (long n = 1'000; n <= 100'000'000; n *= 10)
+            benchmark->Args({n, static_cast<long>(order)});
+    }
+}
+
+static void sizes_and_read_ratios(benchmark::internal::Benchmark *benchmark) {
+    for (const long read_percent: {50, 90, 99}) {
+        for (long n = 1'000; n <= 100'000'000; n *= 10)
+            benchmark->Args({n, read_percent});
+    }
+}
+
+BENCHMARK_TEMPLATE(load_keys, CountedOrderStatisticTree)->Apply(sizes_and_orders)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(load_keys, BPlusOrderStatisticTree<>)->Apply(sizes_and_orders)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(contains_keys, CountedOrderStatisticTree)->Apply(sizes_and_orders);
+BENCHMARK_TEMPLATE(contains_keys, BPlusOrderStatisticTree<>)->Apply(sizes_and_orders);
+BENCHMARK_TEMPLATE(less_count_keys, CountedOrderStatisticTree)->Apply(sizes_and_orders);
+BENCHMARK_TEMPLATE(less_count_keys, BPlusOrderStatisticTree<>)->Apply(sizes_and_orders);
+BENCHMARK_TEMPLATE(find_order_statistic_keys, CountedOrderStatisticTree)->Apply(sizes_and_orders);
+BENCHMARK_TEMPLATE(find_order_statistic_keys, BPlusOrderStatisticTree<>)->Apply(sizes_and_orders);
+BENCHMARK_TEMPLATE(mixed_read_write, CountedOrderStatisticTree)->Apply(sizes_and_read_ratios);
+BENCHMARK_TEMPLATE(mixed_read_write, BPlusOrderStatisticTree<>)->Apply(sizes_and_read_ratios);
@@ -0,0 +1,69 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <vector>
+
+#include "CountingAllocator.h"
+#include "OrderStatisticTree.h"
+#include "PersistentOrderStatisticTree.h"
+#include "Workloads.h"
+
+/**
+ * A stream of changes with a snapshot after every range(1) changes, all snapshots are kept.
+ * A deep copy of the red-black tree is compared with the path-copying persistent tree.
+ * bytes_per_snapshot is the memory held by the tree and its snapshots divided by their number.
+ */
+
+using CountedOrderStatisticTree = BasicOrderStatisticTree<int, std::less<int>, NoAugmentation, CountingAllocator<int>>;
+using CountedPersistentOrderStatisticTree = BasicPersistentOrderStatisticTree<CountingAllocator<int>>;
+
+static constexpr std::size_t CHANGE_COUNT = 1 << 14;
+
+template<class Tree>
+static Tree take_snapshot(const Tree &tree) {
+    if constexpr (requires { tree.snapshot(); })
+        return tree.snapshot();
+    else
+        return tree;
+}
+
+template<class Tree>
+static void snapshot_stream(benchmark::State &state) {
+    const auto n = static_cast<std::size_t>(state.range(0));
+    const auto snapshot_period = static_cast<std::size_t>(state.range(1));
+    const auto changes = random_keys(CHANGE_COUNT, 7);
+    double bytes_per_snapshot = 0;
+    for (auto _: state) {
+        state.PauseTiming();
+        auto tree = std::make_unique<Tree>();
+        for (const auto key: random_keys(n))
+            tree->insert(key);
+        std::vector<Tree> snapshots;
+        state.ResumeTiming();
+
+        for (std::size_t i = 0; i < CHANGE_COUNT; i++) {
+            if (tree->erase(changes[i]) == 0)
+                tree->insert(changes[i]);
+            if ((i + 1) % snapshot_period == 0)
+                snapshots.push_back(take_snapshot(*tree));
+        }
+
+        state.PauseTiming();
+        bytes_per_snapshot = static_cast<double>(counted_bytes) / static_cast<double>(snapshots.size() + 1);
+        snapshots.clear();
+        tree.reset();
+        state.ResumeTiming();
+    }
+    state.counters["bytes_per_snapshot"] = bytes_per_snapshot;
+    state.counters["time_per_change"] = benchmark::Counter(
+            static_cast<double>(CHANGE_COUNT), benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+
+static void sizes_and_periods(benchmark::internal::Benchmark *benchmark) {
+    for (const long period: {16, 256}) {
+        for (long n = 1'000; n <= 100'000; n *= 10)
+            benchmark->Args({n, period});
+    }
+}
+
+BENCHMARK_TEMPLATE(snapshot_stream, CountedOrderStatisticTree)->Apply(sizes_and_periods)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(snapshot_stream, CountedPersistentOrderStatisticTree)->Apply(sizes_and_periods)->Unit(benchmark::kMillisecond);
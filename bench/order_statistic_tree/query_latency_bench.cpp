@@ -0,0 +1,79 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "OrderStatisticTree.h"
+
+/**
+ * Tree of n even keys. It is built from sorted keys, random insertion of 100M keys takes minutes.
+ * The last built tree is kept, so the query benchmarks of one size share it.
+ */
+static const OrderStatisticTree &cached_tree(std::size_t n) {
+    static std::optional<OrderStatisticTree> tree;
+    static std::size_t tree_size = 0;
+    if (!tree || tree_size != n) {
+        tree.reset();
+        std::vector<int> keys(n);
+        std::iota(keys.begin(), keys.end(), 0);
+        for (auto &key: keys)
+            key *= 2;
+        tree.emplace(OrderStatisticTree::build_from_sorted(keys));
+        tree_size = n;
+    }
+    return *tree;
+}
+
+/**
+ * Times every query separately and reports the 50th and 99th percentiles in nanoseconds.
+ * The arguments are generated in advance, the clock overhead (about 20 ns) is included.
+ */
+template<class Argument, class Query>
+static void measure_latency(benchmark::State &state, const std::vector<Argument> &arguments, Query query) {
+    std::vector<double> latencies;
+    std::size_t i = 0;
+    for (auto _: state) {
+        const auto argument = arguments[i++ % arguments.size()];
+        const auto start = std::chrono::steady_clock::now();
+        benchmark::DoNotOptimize(query(argument));
+        const auto finish = std::chrono::steady_clock::now();
+        latencies.push_back(std::chrono::duration<double, std::nano>(finish - start).count());
+    }
+    if (latencies.empty())
+        return;
+    const auto percentile = [&latencies](double fraction) {
+        const auto position = latencies.begin() + static_cast<std::ptrdiff_t>(fraction * (latencies.size() - 1));
+        std::nth_element(latencies.begin(), position, latencies.end());
+        return *position;
+    };
+    state.counters["p50_ns"] = percentile(0.5);
+    state.counters["p99_ns"] = percentile(0.99);
+}
+
+static void less_count_percentiles(benchmark::State &state) {
+    const auto n = static_cast<std::size_t>(state.range(0));
+    const auto &tree = cached_tree(n);
+    std::mt19937 engine(1);
+    std::uniform_int_distribution<int> key_dist(0, static_cast<int>(2 * n));
+    std::vector<int> keys(1 << 16);
+    for (auto &key: keys)
+        key = key_dist(engine);
+    measure_latency(state, keys, [&tree](int key) { return tree.less_count(key); });
+}
+
+static void find_order_statistic_percentiles(benchmark::State &state) {
+    const auto n = static_cast<std::size_t>(state.range(0));
+    const auto &tree = cached_tree(n);
+    std::mt19937 engine(1);
+    std::uniform_int_distribution<std::size_t> k_dist(1, n);
+    std::vector<std::size_t> ranks(1 << 16);
+    for (auto &k: ranks)
+        k = k_dist(engine);
+    measure_latency(state, ranks, [&tree](std::size_t k) { return tree.find_order_statistic(k); });
+}
+
+BENCHMARK(less_count_percentiles)->RangeMultiplier(10)->Range(1'000, 100'000'000);
+BENCHMARK(find_order_statistic_percentiles)->RangeMultiplier(10)->Range(1'000, 100'000'000);
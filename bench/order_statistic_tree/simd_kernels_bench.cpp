@@ -0,0 +1,92 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "BPlusOrderStatisticTree.h"
+#include "SimdKernels.h"
+
+/**
+ * Per-node cost of the kernels: one call searches a node of state.range(0) entries.
+ */
+template<CountLessKernel Kernel>
+static void count_less_per_node(benchmark::State &state) {
+    const auto n = static_cast<std::size_t>(state.range(0));
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::vector<int> queries(1024);
+    std::mt19937 engine(42);
+    std::uniform_int_distribution<int> query_dist(0, static_cast<int>(n));
+    for (auto &query: queries)
+        query = query_dist(engine);
+
+    std::size_t i = 0;
+    for (auto _: state) {
+        benchmark::DoNotOptimize(Kernel(keys.data(), n, queries[i++ & 1023]));
+    }
+}
+
+template<FindRankChildKernel Kernel>
+static void find_rank_child_per_node(benchmark::State &state) {
+    const auto n = static_cast<std::size_t>(state.range(0));
+    std::vector<std::size_t> counts(n, 100);
+    std::vector<std::size_t> queries(1024);
+    std::mt19937 engine(42);
+    std::uniform_int_distribution<std::size_t> query_dist(1, n * 100);
+    for (auto &query: queries)
+        query = query_dist(engine);
+
+    std::size_t i = 0;
+    for (auto _: state) {
+        std::size_t k = queries[i++ & 1023];
+        benchmark::DoNotOptimize(Kernel(counts.data(), n, k));
+        benchmark::DoNotOptimize(k);
+    }
+}
+
+template<class Tree>
+static void wide_node_less_count(benchmark::State &state) {
+    const auto n = static_cast<std::size_t>(state.range(0));
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+    Tree tree;
+    for (const auto key: keys)
+        tree.insert(key);
+    std::mt19937 engine(1);
+    std::uniform_int_distribution<int> key_dist(0, static_cast<int>(n));
+    for (auto _: state)
+        benchmark::DoNotOptimize(tree.less_count(key_dist(engine)));
+}
+
+template<class Tree>
+static void wide_node_find_order_statistic(benchmark::State &state) {
+    const auto n = static_cast<std::size_t>(state.range(0));
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+    Tree tree;
+    for (const auto key: keys)
+        tree.insert(key);
+    std::mt19937 engine(1);
+    std::uniform_int_distribution<std::size_t> k_dist(1, n);
+    for (auto _: state)
+        benchmark::DoNotOptimize(tree.find_order_statistic(k_dist(engine)));
+}
+
+BENCHMARK_TEMPLATE(count_less_per_node, count_less_scalar)->Arg(16)->Arg(32)->Arg(64);
+BENCHMARK_TEMPLATE(find_rank_child_per_node, find_rank_child_scalar)->Arg(16)->Arg(32)->Arg(64);
+#ifdef ORDER_STATISTIC_TREE_X86_KERNELS
+BENCHMARK_TEMPLATE(count_less_per_node, count_less_sse)->Arg(16)->Arg(32)->Arg(64);
+BENCHMARK_TEMPLATE(count_less_per_node, count_less_avx2)->Arg(16)->Arg(32)->Arg(64);
+BENCHMARK_TEMPLATE(find_rank_child_per_node, find_rank_child_sse)->Arg(16)->Arg(32)->Arg(64);
+BENCHMARK_TEMPLATE(find_rank_child_per_node, find_rank_child_avx2)->Arg(16)->Arg(32)->Arg(64);
+#endif
+
+BENCHMARK_TEMPLATE(wide_node_less_count, BPlusOrderStatisticTree<16>)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(wide_node_less_count, BPlusOrderStatisticTree<32>)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(wide_node_less_count, BPlusOrderStatisticTree<64>)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(wide_node_find_order_statistic, BPlusOrderStatisticTree<16>)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(wide_node_find_order_statistic, BPlusOrderStatisticTree<32>)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(wide_node_find_order_statistic, BPlusOrderStatisticTree<64>)->Arg(1 << 20);
@@ -0,0 +1,76 @@
+#include <benchmark/benchmark.h>
+#include <filesystem>
+
+#include "MappedOrderStatisticTree.h"
+#include "OrderStatisticTree.h"
+#include "TreeSnapshot.h"
+#include "Workloads.h"
+
+/**
+ * Startup cost of a tree with range(0) random keys: replaying the insertions, loading a snapshot
+ * into a tree and mapping the snapshot. Then less_count on the loaded tree and on the mapped snapshot.
+ */
+
+static constexpr std::size_t QUERY_COUNT = 1 << 16;
+
+/**
+ * Snapshot of n random keys in the temporary directory, rewritten when the size changes.
+ */
+static std::filesystem::path snapshot_path(std::size_t n) {
+    static std::size_t saved_n = 0;
+    const auto path = std::filesystem::temp_directory_path() / "order_statistic_tree_bench.snapshot";
+    if (saved_n != n) {
+        const auto keys = random_keys(n);
+        OrderStatisticTree tree;
+        tree.bulk_insert(keys);
+        save_tree_snapshot(tree, path);
+        saved_n = n;
+    }
+    return path;
+}
+
+static void replay_inserts(benchmark::State &state) {
+    const auto keys = random_keys(static_cast<std::size_t>(state.range(0)));
+    for (auto _: state) {
+        OrderStatisticTree tree;
+        for (const auto key: keys)
+            tree.insert(key);
+        benchmark::DoNotOptimize(tree.size());
+    }
+}
+
+static void load_snapshot(benchmark::State &state) {
+    const auto path = snapshot_path(static_cast<std::size_t>(state.range(0)));
+    for (auto _: state)
+        benchmark::DoNotOptimize(load_tree_snapshot<OrderStatisticTree>(path).size());
+}
+
+static void map_snapshot(benchmark::State &state) {
+    const auto path = snapshot_path(static_cast<std::size_t>(state.range(0)));
+    for (auto _: state)
+        benchmark::DoNotOptimize(MappedOrderStatisticTree<>(path).size());
+}
+
+template<class Tree>
+static void less_count_queries(benchmark::State &state, const Tree &tree) {
+    const auto keys = random_keys(QUERY_COUNT, 7);
+    std::size_t i = 0;
+    for (auto _: state)
+        benchmark::DoNotOptimize(tree.less_count(keys[i++ % QUERY_COUNT]));
+}
+
+static void loaded_tree_less_count(benchmark::State &state) {
+    const auto tree = load_tree_snapshot<OrderStatisticTree>(snapshot_path(static_cast<std::size_t>(state.range(0))));
+    less_count_queries(state, tree);
+}
+
+static void mapped_tree_less_count(benchmark::State &state) {
+    const MappedOrderStatisticTree<> tree(snapshot_path(static_cast<std::size_t>(state.range(0))));
+    less_count_queries(state, tree);
+}
+
+BENCHMARK(replay_inserts)->RangeMultiplier(10)->Range(100'000, 10'000'000)->Unit(benchmark::kMillisecond);
+BENCHMARK(load_snapshot)->RangeMultiplier(10)->Range(100'000, 10'000'000)->Unit(benchmark::kMillisecond);
+BENCHMARK(map_snapshot)->RangeMultiplier(10)->Range(100'000, 10'000'000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(loaded_tree_less_count)->RangeMultiplier(10)->Range(100'000, 10'000'000);
+BENCHMARK(mapped_tree_less_count)->RangeMultiplier(10)->Range(100'000, 10'000'000);
@@ -0,0 +1,65 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <thread>
+
+#include "OrderStatisticTree.h"
+#include "Workloads.h"
+
+/**
+ * Union of a tree of range(0) random keys with a tree of range(1) random keys:
+ * inserting the keys one by one, bulk_insert and unite with 1 or all hardware threads.
+ * The trees are copied with the timer paused, only the union is measured.
+ */
+
+static constexpr int INSERT_LOOP = 0;
+static constexpr int BULK_INSERT = 1;
+static constexpr int UNITE = 2;
+static constexpr int PARALLEL_UNITE = 3;
+
+static void unite_trees(benchmark::State &state) {
+    const auto n = static_cast<std::size_t>(state.range(0));
+    const auto m = static_cast<std::size_t>(state.range(1));
+    const auto method = static_cast<int>(state.range(2));
+    const auto added_keys = random_keys(m, 7);
+    OrderStatisticTree base;
+    OrderStatisticTree added;
+    base.bulk_insert(random_keys(n));
+    added.bulk_insert(added_keys);
+    const auto threads = std::max(1u, std::thread::hardware_concurrency());
+    for (auto _: state) {
+        state.PauseTiming();
+        auto tree = base;
+        auto other = added;
+        state.ResumeTiming();
+        switch (method) {
+            case INSERT_LOOP:
+                for (const auto key: other)
+                    tree.insert(key);
+                break;
+            case BULK_INSERT:
+                tree.bulk_insert(added_keys);
+                break;
+            case UNITE:
+                tree.unite(std::move(other));
+                break;
+            default:
+                tree.unite(std::move(other), threads);
+        }
+        benchmark::DoNotOptimize(tree.size());
+        state.PauseTiming();
+        tree.clear();
+        other.clear();
+        state.ResumeTiming();
+    }
+    const char *labels[] = {"insert loop", "bulk_insert", "unite", "parallel unite"};
+    state.SetLabel(labels[method]);
+}
+
+static void sizes_and_methods(benchmark::internal::Benchmark *benchmark) {
+    for (const long method: {INSERT_LOOP, BULK_INSERT, UNITE, PARALLEL_UNITE}) {
+        for (const long m: {1'000, 100'000, 1'000'000})
+            benchmark->Args({1'000'000, m, method});
+    }
+}
+
+BENCHMARK(unite_trees)->Apply(sizes_and_methods)->Unit(benchmark::kMillisecond);
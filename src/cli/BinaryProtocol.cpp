@@ -0,0 +1,90 @@
+#include "BinaryProtocol.h"
+
+#include <algorithm>
+#include <climits>
+#include <vector>
+
+/** Number of records read and answered at once. */
+static constexpr std::size_t BLOCK_RECORDS = 1 << 12;
+
+BinaryRecord decode_record(const char *bytes) {
+    std::uint64_t value = 0;
+    for (std::size_t i = 0; i < 8; i++)
+        value |= static_cast<std::uint64_t>(static_cast<unsigned char>(bytes[8 + i])) << (8 * i);
+    return BinaryRecord{static_cast<std::uint8_t>(bytes[0]), static_cast<std::int64_t>(value)};
+}
+
+void encode_record(const BinaryRecord &record, char *bytes) {
+    bytes[0] = static_cast<char>(record.code);
+    for (std::size_t i = 1; i < 8; i++)
+        bytes[i] = 0;
+    const auto value = static_cast<std::uint64_t>(record.value);
+    for (std::size_t i = 0; i < 8; i++)
+        bytes[8 + i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+}
+
+static BinaryStatus to_binary_status(StorageStatus status) {
+    switch (status) {
+        case StorageStatus::OK:
+            return BinaryStatus::OK;
+        case StorageStatus::KEY_EXISTS:
+            return BinaryStatus::KEY_EXISTS;
+        case StorageStatus::KEY_NOT_FOUND:
+            return BinaryStatus::KEY_NOT_FOUND;
+        case StorageStatus::RANK_OUT_OF_RANGE:
+            return BinaryStatus::RANK_OUT_OF_RANGE;
+        case StorageStatus::UNSUPPORTED_QUERY:
+            return BinaryStatus::UNSUPPORTED_QUERY;
+        case StorageStatus::LOG_WRITE_FAILED:
+            return BinaryStatus::LOG_WRITE_FAILED;
+    }
+    return BinaryStatus::UNKNOWN_QUERY;
+}
+
+static BinaryRecord make_response(BinaryStatus status, std::int64_t value = 0) {
+    return BinaryRecord{static_cast<std::uint8_t>(status), value};
+}
+
+BinaryRecord execute_binary_query(KeyStorage &storage, const BinaryRecord &request) {
+    if (request.code == 'm') {
+        if (request.value <= 0)
+            return make_response(BinaryStatus::RANK_OUT_OF_RANGE);
+        int key = 0;
+        const auto status = storage.try_find_order_statistic(static_cast<std::size_t>(request.value), key);
+        return make_response(to_binary_status(status), key);
+    }
+    if (request.code != 'k' && request.code != 'd' && request.code != 'n')
+        return make_response(BinaryStatus::UNKNOWN_QUERY);
+    if (request.value < INT_MIN || request.value > INT_MAX)
+        return make_response(BinaryStatus::INVALID_ARGUMENT);
+    const auto key = static_cast<int>(request.value);
+    if (request.code == 'k')
+        return make_response(to_binary_status(storage.try_insert_key(key)));
+    if (request.code == 'd')
+        return make_response(to_binary_status(storage.try_erase_key(key)));
+    return make_response(BinaryStatus::OK, static_cast<std::int64_t>(storage.get_less_count(key)));
+}
+
+bool run_binary_queries(KeyStorage &storage, std::istream &input, std::ostream &output) {
+    std::vector<char> requests(BLOCK_RECORDS * BINARY_RECORD_SIZE);
+    std::vector<char> responses(requests.size());
+    std::size_t buffered = 0;
+    while (true) {
+        const auto read = input.rdbuf()->sgetn(requests.data() + buffered,
+                                               static_cast<std::streamsize>(requests.size() - buffered));
+        if (read <= 0)
+            break;
+        buffered += static_cast<std::size_t>(read);
+        const std::size_t records = buffered / BINARY_RECORD_SIZE;
+        for (std::size_t i = 0; i < records; i++) {
+            const auto request = decode_record(requests.data() + i * BINARY_RECORD_SIZE);
+            encode_record(execute_binary_query(storage, request), responses.data() + i * BINARY_RECORD_SIZE);
+        }
+        output.write(responses.data(), static_cast<std::streamsize>(records * BINARY_RECORD_SIZE));
+        const std::size_t rest = buffered - records * BINARY_RECORD_SIZE;
+        std::copy_n(requests.data() + records * BINARY_RECORD_SIZE, rest, requests.data());
+        buffered = rest;
+    }
+    output.flush();
+    return buffered == 0;
+}
@@ -0,0 +1,50 @@
+#ifndef ORDER_STATISTIC_TREE_BINARYPROTOCOL_H
+#define ORDER_STATISTIC_TREE_BINARYPROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+#include "KeyStorage.h"
+
+/**
+ * Binary framing of the CLI queries (--binary). Requests and responses are records of BINARY_RECORD_SIZE bytes:
+ * a one-byte code, 7 zero bytes and a 64-bit little-endian signed value.
+ * A request code is the letter of the text query ('k', 'd', 'm' or 'n') and the value is its argument.
+ * A response code is a BinaryStatus, the value is the found key for 'm', the count for 'n' and 0 otherwise.
+ */
+inline constexpr std::size_t BINARY_RECORD_SIZE = 16;
+
+enum class BinaryStatus : std::uint8_t {
+    OK = 0,
+    KEY_EXISTS = 1,
+    KEY_NOT_FOUND = 2,
+    RANK_OUT_OF_RANGE = 3,
+    UNKNOWN_QUERY = 4,
+    /** The key doesn't fit into int. */
+    INVALID_ARGUMENT = 5,
+    /** The storage engine can't execute the query, e.g. 'd' of the kll engine. */
+    UNSUPPORTED_QUERY = 6,
+    /** The change couldn't be written to the write-ahead log and is not applied. */
+    LOG_WRITE_FAILED = 7
+};
+
+struct BinaryRecord {
+    std::uint8_t code = 0;
+    std::int64_t value = 0;
+};
+
+BinaryRecord decode_record(const char *bytes);
+
+void encode_record(const BinaryRecord &record, char *bytes);
+
+BinaryRecord execute_binary_query(KeyStorage &storage, const BinaryRecord &request);
+
+/**
+ * Answers all records of input, the responses are written to output in large chunks.
+ * Returns false if the input ends with an incomplete record, it is ignored.
+ */
+bool run_binary_queries(KeyStorage &storage, std::istream &input, std::ostream &output);
+
+#endif //ORDER_STATISTIC_TREE_BINARYPROTOCOL_H
@@ -0,0 +1,61 @@
+#include "CliOptions.h"
+
+#include <charconv>
+#include <stdexcept>
+#include <string_view>
+
+static StorageEngine parse_engine(std::string_view name) {
+    if (name == "rb-tree")
+        return StorageEngine::RED_BLACK_TREE;
+    else if (name == "b-plus-tree")
+        return StorageEngine::B_PLUS_TREE;
+    else if (name == "rb-multiset")
+        return StorageEngine::RED_BLACK_MULTISET;
+    else if (name == "kll")
+        return StorageEngine::KLL_SKETCH;
+    throw std::invalid_argument("Unknown storage engine: " + std::string(name) + ".");
+}
+
+static std::size_t parse_count(std::string_view value) {
+    std::size_t count = 0;
+    const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), count);
+    if (value.empty() || error != std::errc() || end != value.data() + value.size())
+        throw std::invalid_argument("Expected a non-negative integer: " + std::string(value) + ".");
+    return count;
+}
+
+CliOptions parse_cli_options(int argc, const char *const argv[]) {
+    constexpr std::string_view engine_option = "--engine=";
+    constexpr std::string_view snapshot_option = "--snapshot=";
+    constexpr std::string_view wal_option = "--wal=";
+    constexpr std::string_view sync_every_option = "--sync-every=";
+
+    CliOptions options;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        if (arg.starts_with(engine_option))
+            options.engine = parse_engine(arg.substr(engine_option.size()));
+        else if (arg.starts_with(snapshot_option) && arg.size() > snapshot_option.size())
+            options.snapshot_path = arg.substr(snapshot_option.size());
+        else if (arg.starts_with(wal_option) && arg.size() > wal_option.size())
+            options.wal_directory = arg.substr(wal_option.size());
+        else if (arg.starts_with(sync_every_option))
+            options.sync_every = parse_count(arg.substr(sync_every_option.size()));
+        else if (arg == "--binary")
+            options.binary = true;
+        else
+            throw std::invalid_argument("Unknown option: " + std::string(arg) + ".");
+    }
+    if (!options.snapshot_path.empty() && !options.wal_directory.empty())
+        throw std::invalid_argument("--snapshot and --wal can't be used together.");
+    if (!options.snapshot_path.empty() && options.engine == StorageEngine::KLL_SKETCH)
+        throw std::invalid_argument("--snapshot can't be used with the kll engine.");
+    if (!options.wal_directory.empty() && options.engine == StorageEngine::KLL_SKETCH)
+        throw std::invalid_argument("--wal can't be used with the kll engine.");
+    return options;
+}
+
+std::string cli_usage() {
+    return "Usage: cli_order_statistic_tree_bootstrap [--engine=rb-tree|b-plus-tree|rb-multiset|kll] [--binary]\n"
+           "    [--snapshot=path | --wal=directory [--sync-every=n]]\n";
+}
@@ -0,0 +1,27 @@
+#ifndef ORDER_STATISTIC_TREE_CLIOPTIONS_H
+#define ORDER_STATISTIC_TREE_CLIOPTIONS_H
+
+#include <string>
+
+#include "KeyStorage.h"
+
+struct CliOptions {
+    StorageEngine engine = StorageEngine::RED_BLACK_TREE;
+    /** Queries and responses are fixed-size binary records, see BinaryProtocol.h. */
+    bool binary = false;
+    /** If not empty, the keys are loaded from this snapshot (when it exists) and saved to it at the end of input. */
+    std::string snapshot_path{};
+    /** If not empty, the keys are recovered from this directory and every change is logged to it. */
+    std::string wal_directory{};
+    /** DurabilityOptions::sync_every of the log. */
+    std::size_t sync_every = 1;
+};
+
+/**
+ * Parses command line arguments of the CLI, throws std::invalid_argument on unknown ones.
+ */
+CliOptions parse_cli_options(int argc, const char *const argv[]);
+
+std::string cli_usage();
+
+#endif //ORDER_STATISTIC_TREE_CLIOPTIONS_H
@@ -1,18 +1,179 @@
 #include "KeyStorage.h"
 
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "TreeSnapshot.h"
+
+static void throw_on_error(StorageStatus status) {
+    if (status != StorageStatus::OK)
+        throw std::invalid_argument(std::string(status_message(status)));
+}
+
+KeyStorage::KeyStorage(StorageEngine engine) {
+    if (engine == StorageEngine::B_PLUS_TREE)
+        storage.emplace<BPlusOrderStatisticTree<>>();
+    else if (engine == StorageEngine::RED_BLACK_MULTISET)
+        storage.emplace<RedBlackMultiset>();
+    else if (engine == StorageEngine::KLL_SKETCH)
+        storage.emplace<KllSketch<>>();
+}
+
+KeyStorage::KeyStorage(StorageEngine engine, const DurabilityOptions &durability) : KeyStorage(engine) {
+    if (engine == StorageEngine::KLL_SKETCH)
+        throw std::logic_error("The approximate storage can't be durable!");
+    auto recovered = WriteAheadLog::recover(durability.directory);
+    load_keys(recovered.checkpoint_keys);
+    for (const auto &record: recovered.tail) {
+        if (record.operation == LogOperation::INSERT)
+            try_insert_key(record.key);
+        else
+            try_erase_key(record.key);
+    }
+    log = std::make_unique<WriteAheadLog>(durability);
+}
+
 std::size_t KeyStorage::get_less_count(int key) {
-    return storage.less_count(key);
+    return std::visit([key](const auto &tree) { return tree.less_count(key); }, storage);
 }
 
 int KeyStorage::find_order_statistic(std::size_t k) {
-    if (k > storage.size() || k <= 0)
-        throw std::invalid_argument("The key number must be greater than zero, "
-                                    "but not greater than the storage size.");
-    return storage.find_order_statistic(k);
+    int key = 0;
+    throw_on_error(try_find_order_statistic(k, key));
+    return key;
 }
 
 void KeyStorage::insert_key(int key) {
-    if (storage.contains(key))
-        throw std::invalid_argument("The key already exists. Try something different.");
-    storage.insert(key);
+    throw_on_error(try_insert_key(key));
+}
+
+void KeyStorage::erase_key(int key) {
+    throw_on_error(try_erase_key(key));
+}
+
+StorageStatus KeyStorage::try_find_order_statistic(std::size_t k, int &key) {
+    return std::visit([k, &key](auto &tree) {
+        if (k > tree.size() || k <= 0)
+            return StorageStatus::RANK_OUT_OF_RANGE;
+        key = tree.find_order_statistic(k);
+        return StorageStatus::OK;
+    }, storage);
+}
+
+StorageStatus KeyStorage::try_insert_key(int key) {
+    const bool inserted = std::visit([key](auto &tree) {
+        if constexpr (std::is_same_v<std::decay_t<decltype(tree)>, KllSketch<>>) {
+            tree.insert(key);
+            return true;
+        } else {
+            return tree.insert(key).second;
+        }
+    }, storage);
+    if (!inserted)
+        return StorageStatus::KEY_EXISTS;
+    if (log && !log_change(LogOperation::INSERT, key)) {
+        std::visit([key](auto &tree) {
+            using Tree = std::decay_t<decltype(tree)>;
+            if constexpr (std::is_same_v<Tree, RedBlackMultiset>)
+                tree.erase(tree.find(key));
+            else if constexpr (!std::is_same_v<Tree, KllSketch<>>)
+                tree.erase(key);
+        }, storage);
+        return StorageStatus::LOG_WRITE_FAILED;
+    }
+    return StorageStatus::OK;
+}
+
+StorageStatus KeyStorage::try_erase_key(int key) {
+    const auto status = std::visit([key](auto &tree) {
+        using Tree = std::decay_t<decltype(tree)>;
+        if constexpr (std::is_same_v<Tree, KllSketch<>>) {
+            return StorageStatus::UNSUPPORTED_QUERY;
+        } else if constexpr (std::is_same_v<Tree, RedBlackMultiset>) {
+            const auto position = tree.find(key);
+            if (position == tree.end())
+                return StorageStatus::KEY_NOT_FOUND;
+            tree.erase(position);
+            return StorageStatus::OK;
+        } else {
+            return tree.erase(key) == 0 ? StorageStatus::KEY_NOT_FOUND : StorageStatus::OK;
+        }
+    }, storage);
+    if (status == StorageStatus::OK && log && !log_change(LogOperation::ERASE, key)) {
+        std::visit([key](auto &tree) {
+            if constexpr (!std::is_same_v<std::decay_t<decltype(tree)>, KllSketch<>>)
+                tree.insert(key);
+        }, storage);
+        return StorageStatus::LOG_WRITE_FAILED;
+    }
+    return status;
+}
+
+void KeyStorage::save(const std::filesystem::path &path) const {
+    std::visit([&path](const auto &tree) {
+        if constexpr (std::is_same_v<std::decay_t<decltype(tree)>, KllSketch<>>)
+            throw std::logic_error("The approximate storage can't save a snapshot!");
+        else
+            write_tree_snapshot<int>(path, tree.begin(), tree.end(), tree.size());
+    }, storage);
+}
+
+void KeyStorage::load(const std::filesystem::path &path) {
+    if (log)
+        throw std::logic_error("A durable storage can't load a snapshot!");
+    load_keys(read_tree_snapshot<int>(path));
+}
+
+WriteAheadLog *KeyStorage::write_ahead_log() const {
+    return log.get();
+}
+
+bool KeyStorage::log_change(LogOperation operation, int key) {
+    try {
+        log->append(operation, key);
+        return true;
+    } catch (const std::exception &) {
+        // The change is answered with LOG_WRITE_FAILED, the query loop goes on.
+        return false;
+    }
+}
+
+void KeyStorage::load_keys(const std::vector<int> &keys) {
+    std::visit([&keys](auto &tree) {
+        using Tree = std::decay_t<decltype(tree)>;
+        if constexpr (std::is_same_v<Tree, BPlusOrderStatisticTree<>>) {
+            if (std::adjacent_find(keys.begin(), keys.end(), std::greater_equal<>()) != keys.end())
+                throw std::invalid_argument("Keys must be sorted and unique!");
+            tree.clear();
+            for (const auto key: keys)
+                tree.insert(key);
+        } else if constexpr (std::is_same_v<Tree, KllSketch<>>) {
+            tree.clear();
+            for (const auto key: keys)
+                tree.insert(key);
+        } else {
+            tree = Tree::build_from_sorted(keys);
+        }
+    }, storage);
+}
+
+std::string_view status_message(StorageStatus status) {
+    switch (status) {
+        case StorageStatus::OK:
+            return "";
+        case StorageStatus::KEY_EXISTS:
+            return "The key already exists. Try something different.";
+        case StorageStatus::KEY_NOT_FOUND:
+            return "The key doesn't exist.";
+        case StorageStatus::RANK_OUT_OF_RANGE:
+            return "The key number must be greater than zero, but not greater than the storage size.";
+        case StorageStatus::UNSUPPORTED_QUERY:
+            return "The storage engine doesn't support this query.";
+        case StorageStatus::LOG_WRITE_FAILED:
+            return "Can't write the change to the log, it is not applied.";
+    }
+    return "";
 }
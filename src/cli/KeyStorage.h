@@ -1,18 +1,104 @@
 #ifndef ORDER_STATISTIC_TREE_KEYSTORAGE_H
 #define ORDER_STATISTIC_TREE_KEYSTORAGE_H
 
+#include <filesystem>
+#include <memory>
+#include <string_view>
+#include <variant>
+
+#include "BPlusOrderStatisticTree.h"
+#include "KllSketch.h"
+#include "NodeArena.h"
 #include "OrderStatisticTree.h"
+#include "WriteAheadLog.h"
+
+enum class StorageEngine {
+    RED_BLACK_TREE,
+    B_PLUS_TREE,
+    /** Red-black tree that keeps duplicate keys as node multiplicities. */
+    RED_BLACK_MULTISET,
+    /**
+     * Approximate ranks and order statistics in bounded memory, see KllSketch.
+     * Every insert is accepted, keys can't be erased and the keys can't be saved to a snapshot or a log:
+     * a log keeps every insert and would take the memory the sketch saves.
+     */
+    KLL_SKETCH
+};
+
+/**
+ * Result of a storage operation, the try_ methods report errors with it instead of exceptions.
+ */
+enum class StorageStatus {
+    OK,
+    KEY_EXISTS,
+    KEY_NOT_FOUND,
+    RANK_OUT_OF_RANGE,
+    /** The storage engine can't execute the query. */
+    UNSUPPORTED_QUERY,
+    /** The change couldn't be written to the log of a durable storage, so it is not applied. */
+    LOG_WRITE_FAILED
+};
+
+std::string_view status_message(StorageStatus status);
 
 class KeyStorage {
 public:
+    explicit KeyStorage(StorageEngine engine = StorageEngine::RED_BLACK_TREE);
+
+    /**
+     * Durable storage: recovers the keys from durability.directory, then logs every successful change
+     * before it is acknowledged, see WriteAheadLog. The kll engine can't be durable, it throws std::logic_error.
+     */
+    KeyStorage(StorageEngine engine, const DurabilityOptions &durability);
+
     std::size_t get_less_count(int key);
 
+    /**
+     * The throwing methods throw std::invalid_argument with the status message.
+     */
     int find_order_statistic(std::size_t k);
 
     void insert_key(int key);
 
+    void erase_key(int key);
+
+    StorageStatus try_find_order_statistic(std::size_t k, int &key);
+
+    StorageStatus try_insert_key(int key);
+
+    StorageStatus try_erase_key(int key);
+
+    /**
+     * Writes the keys to a snapshot file, see TreeSnapshot.h.
+     * The sketch doesn't keep the keys, it throws std::logic_error.
+     */
+    void save(const std::filesystem::path &path) const;
+
+    /**
+     * Replaces the keys with the keys of a snapshot file. Throws std::runtime_error if the file can't be read
+     * and std::invalid_argument if it has repeated keys for an engine without duplicates.
+     * A durable storage can't load a snapshot, it throws std::logic_error.
+     */
+    void load(const std::filesystem::path &path);
+
+    /**
+     * The log of a durable storage, nullptr otherwise.
+     */
+    [[nodiscard]] WriteAheadLog *write_ahead_log() const;
+
 private:
-    OrderStatisticTree storage;
+    using RedBlackTree = BasicOrderStatisticTree<int, std::less<int>, NoAugmentation, NodeArena<int>>;
+    using RedBlackMultiset = BasicOrderStatisticTree<int, std::less<int>, NoAugmentation, NodeArena<int>, true>;
+
+    std::variant<RedBlackTree, BPlusOrderStatisticTree<>, RedBlackMultiset, KllSketch<>> storage;
+    std::unique_ptr<WriteAheadLog> log;
+
+    void load_keys(const std::vector<int> &keys);
+
+    /**
+     * Logs a change of a durable storage, false if the log can't be written.
+     */
+    bool log_change(LogOperation operation, int key);
 };
 
 
@@ -0,0 +1,47 @@
+#include "LineReader.h"
+
+#include <algorithm>
+#include <cstring>
+
+LineReader::LineReader(std::istream &input, bool line_mode, std::size_t block_size) :
+        input(input), line_mode(line_mode), buffer(line_mode ? 0 : std::max<std::size_t>(block_size, 1)) {}
+
+bool LineReader::next_line(std::string_view &line) {
+    if (line_mode) {
+        if (!std::getline(input, last_line))
+            return false;
+        line = last_line;
+        return true;
+    }
+    while (true) {
+        const auto first = buffer.data() + begin;
+        const auto line_end = static_cast<const char *>(std::memchr(first, '\n', end - begin));
+        if (line_end) {
+            line = std::string_view(first, line_end - first);
+            begin += line.size() + 1;
+            return true;
+        }
+        if (end_of_input) {
+            if (begin == end)
+                return false;
+            line = std::string_view(first, end - begin);
+            begin = end;
+            return true;
+        }
+        read_block();
+    }
+}
+
+void LineReader::read_block() {
+    std::copy(buffer.begin() + static_cast<std::ptrdiff_t>(begin), buffer.begin() + static_cast<std::ptrdiff_t>(end),
+              buffer.begin());
+    end -= begin;
+    begin = 0;
+    if (end == buffer.size())
+        buffer.resize(buffer.size() * 2);
+    const auto read = input.rdbuf()->sgetn(buffer.data() + end, static_cast<std::streamsize>(buffer.size() - end));
+    if (read <= 0)
+        end_of_input = true;
+    else
+        end += static_cast<std::size_t>(read);
+}
@@ -0,0 +1,43 @@
+#ifndef ORDER_STATISTIC_TREE_LINEREADER_H
+#define ORDER_STATISTIC_TREE_LINEREADER_H
+
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Reads lines of a stream in large blocks straight from its stream buffer.
+ * A line is a view into the buffer, valid until the next call, so reading doesn't allocate per line.
+ * In line mode (interactive input) every line is read with getline instead,
+ * so a query is answered before the next one is typed.
+ */
+class LineReader {
+public:
+    static constexpr std::size_t DEFAULT_BLOCK_SIZE = 1 << 20;
+
+    explicit LineReader(std::istream &input, bool line_mode = false, std::size_t block_size = DEFAULT_BLOCK_SIZE);
+
+    /**
+     * Returns false at the end of the input. The last line may have no line break.
+     */
+    bool next_line(std::string_view &line);
+
+private:
+    std::istream &input;
+    bool line_mode;
+    std::string last_line;
+    std::vector<char> buffer;
+    /** Unread data is buffer[begin, end). */
+    std::size_t begin = 0;
+    std::size_t end = 0;
+    bool end_of_input = false;
+
+    /**
+     * Moves the unread data to the front and appends the next block, the buffer grows for a long line.
+     */
+    void read_block();
+};
+
+#endif //ORDER_STATISTIC_TREE_LINEREADER_H
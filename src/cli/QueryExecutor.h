@@ -1,8 +1,8 @@
 #ifndef ORDER_STATISTIC_TREE_QUERYEXECUTOR_H
 #define ORDER_STATISTIC_TREE_QUERYEXECUTOR_H
 
-#include <functional>
-#include <memory>
+#include <string>
+#include <string_view>
 
 #include "queries/Query.h"
 
@@ -10,18 +10,16 @@ class QueryExecutor {
 public:
     explicit QueryExecutor(KeyStorage &storage);
 
-    std::string execute_query(const std::string &query);
+    /**
+     * Appends the response to the query to output, without a line break.
+     * Allocates nothing while output has enough capacity, errors are reported in the response.
+     */
+    void execute_query(std::string_view query, std::string &output);
+
+    std::string execute_query(std::string_view query);
 
 private:
     KeyStorage &storage;
-    std::unordered_map<
-            std::string,
-            std::function<std::unique_ptr<Query>(const std::string &)>
-    > query_names;
-
-    void fill_queries();
-
-    std::unique_ptr<Query> parse_query(const std::string &query_str) const;
 };
 
 
@@ -0,0 +1,160 @@
+#include "ShardedKeyStorage.h"
+
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "KeyStorage.h"
+
+ShardedKeyStorage::ShardedKeyStorage(std::size_t shard_count) :
+        shards(std::make_unique<Shard[]>(shard_count)),
+        shard_counts(std::make_unique<std::atomic<std::ptrdiff_t>[]>(shard_count + 1)),
+        shards_number(shard_count),
+        lower_bounds(shard_count) {
+    if (shard_count == 0)
+        throw std::invalid_argument("The number of shards must be greater than zero.");
+    // Until the first rebalance the int range is split into equal parts.
+    const auto range_width = (std::uint64_t(1) << 32) / shard_count;
+    for (std::size_t i = 0; i < shard_count; i++)
+        lower_bounds[i] = static_cast<int>(INT_MIN + static_cast<std::int64_t>(i * range_width));
+    for (std::size_t i = 0; i <= shard_count; i++)
+        shard_counts[i].store(0, std::memory_order_relaxed);
+}
+
+std::size_t ShardedKeyStorage::get_less_count(int key) {
+    std::shared_lock layout_lock(layout_mutex);
+    const auto shard = shard_of(key);
+    std::lock_guard lock(shards[shard].mutex);
+    return count_before(shard) + shards[shard].tree.less_count(key);
+}
+
+int ShardedKeyStorage::find_order_statistic(std::size_t k) {
+    std::shared_lock layout_lock(layout_mutex);
+    while (true) {
+        if (k > total_size.load() || k <= 0)
+            throw std::invalid_argument(std::string(status_message(StorageStatus::RANK_OUT_OF_RANGE)));
+        auto local_k = k;
+        const auto shard = find_shard(local_k);
+        std::lock_guard lock(shards[shard].mutex);
+        // The counts could have changed after the shard was chosen, then the search is repeated.
+        if (local_k >= 1 && local_k <= shards[shard].tree.size())
+            return shards[shard].tree.find_order_statistic(local_k);
+    }
+}
+
+void ShardedKeyStorage::insert_key(int key) {
+    bool skewed;
+    {
+        std::shared_lock layout_lock(layout_mutex);
+        const auto shard = shard_of(key);
+        std::lock_guard lock(shards[shard].mutex);
+        if (!shards[shard].tree.insert(key).second)
+            throw std::invalid_argument(std::string(status_message(StorageStatus::KEY_EXISTS)));
+        add_to_count(shard, 1);
+        total_size.fetch_add(1);
+        skewed = is_skewed(shards[shard].tree.size());
+    }
+    if (skewed)
+        rebalance();
+}
+
+void ShardedKeyStorage::erase_key(int key) {
+    std::shared_lock layout_lock(layout_mutex);
+    const auto shard = shard_of(key);
+    std::lock_guard lock(shards[shard].mutex);
+    if (shards[shard].tree.erase(key) == 0)
+        throw std::invalid_argument(std::string(status_message(StorageStatus::KEY_NOT_FOUND)));
+    add_to_count(shard, -1);
+    total_size.fetch_sub(1);
+}
+
+std::size_t ShardedKeyStorage::size() const {
+    return total_size.load();
+}
+
+std::size_t ShardedKeyStorage::shard_count() const {
+    return shards_number;
+}
+
+std::vector<std::size_t> ShardedKeyStorage::shard_sizes() const {
+    std::shared_lock layout_lock(layout_mutex);
+    std::vector<std::size_t> sizes(shards_number);
+    for (std::size_t i = 0; i < shards_number; i++) {
+        std::lock_guard lock(shards[i].mutex);
+        sizes[i] = shards[i].tree.size();
+    }
+    return sizes;
+}
+
+std::size_t ShardedKeyStorage::rebalance_count() const {
+    return rebalances.load();
+}
+
+std::size_t ShardedKeyStorage::shard_of(int key) const {
+    return std::upper_bound(lower_bounds.begin() + 1, lower_bounds.end(), key) - lower_bounds.begin() - 1;
+}
+
+void ShardedKeyStorage::add_to_count(std::size_t shard, std::ptrdiff_t delta) {
+    for (auto i = shard + 1; i <= shards_number; i += i & -i)
+        shard_counts[i].fetch_add(delta, std::memory_order_relaxed);
+}
+
+std::size_t ShardedKeyStorage::count_before(std::size_t shard) const {
+    std::ptrdiff_t count = 0;
+    for (auto i = shard; i > 0; i -= i & -i)
+        count += shard_counts[i].load(std::memory_order_relaxed);
+    return static_cast<std::size_t>(std::max<std::ptrdiff_t>(count, 0));
+}
+
+std::size_t ShardedKeyStorage::find_shard(std::size_t &k) const {
+    std::size_t position = 0;
+    for (auto step = std::bit_floor(shards_number); step > 0; step >>= 1) {
+        const auto next = position + step;
+        if (next > shards_number)
+            continue;
+        const auto count = shard_counts[next].load(std::memory_order_relaxed);
+        if (count >= 0 && static_cast<std::size_t>(count) < k) {
+            position = next;
+            k -= static_cast<std::size_t>(count);
+        }
+    }
+    return std::min(position, shards_number - 1);
+}
+
+bool ShardedKeyStorage::is_skewed(std::size_t shard_size) const {
+    return shard_size >= MIN_REBALANCE_SIZE && shard_size > SKEW_FACTOR * total_size.load() / shards_number;
+}
+
+void ShardedKeyStorage::rebalance() {
+    std::unique_lock layout_lock(layout_mutex);
+    // Another thread could have rebalanced while this one was waiting for the lock.
+    std::size_t largest = 0;
+    for (std::size_t i = 0; i < shards_number; i++)
+        largest = std::max(largest, shards[i].tree.size());
+    if (!is_skewed(largest))
+        return;
+
+    std::vector<int> keys;
+    keys.reserve(total_size.load());
+    for (std::size_t i = 0; i < shards_number; i++) {
+        keys.insert(keys.end(), shards[i].tree.begin(), shards[i].tree.end());
+        shards[i].tree.clear();
+    }
+    for (std::size_t i = 0; i <= shards_number; i++)
+        shard_counts[i].store(0, std::memory_order_relaxed);
+
+    for (std::size_t i = 0; i < shards_number; i++) {
+        const auto first = keys.size() * i / shards_number;
+        const auto last = keys.size() * (i + 1) / shards_number;
+        if (i > 0)
+            lower_bounds[i] = first < keys.size() ? keys[first] : lower_bounds[i - 1];
+        shards[i].tree = OrderStatisticTree::build_from_sorted(
+                std::vector<int>(keys.begin() + static_cast<std::ptrdiff_t>(first),
+                                 keys.begin() + static_cast<std::ptrdiff_t>(last)));
+        add_to_count(i, static_cast<std::ptrdiff_t>(last - first));
+    }
+    rebalances.fetch_add(1);
+}
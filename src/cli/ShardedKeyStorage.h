@@ -0,0 +1,87 @@
+#ifndef ORDER_STATISTIC_TREE_SHARDEDKEYSTORAGE_H
+#define ORDER_STATISTIC_TREE_SHARDEDKEYSTORAGE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+#include "OrderStatisticTree.h"
+
+/**
+ * Key storage for many threads: the key space is split into ranges (shards),
+ * each one is an independent OrderStatisticTree with its own lock, so inserts
+ * into different shards run in parallel.
+ *
+ * Global ranks add the sizes of the preceding shards, which are kept in a Fenwick tree
+ * of atomic counters. When a shard grows to SKEW_FACTOR times the average size,
+ * the boundaries are recomputed and all shards are rebuilt from the sorted keys.
+ * A query sees a consistent shard, but the other shards may change during a global rank query.
+ */
+class ShardedKeyStorage {
+public:
+    explicit ShardedKeyStorage(std::size_t shard_count = 16);
+
+    std::size_t get_less_count(int key);
+
+    int find_order_statistic(std::size_t k);
+
+    void insert_key(int key);
+
+    void erase_key(int key);
+
+    [[nodiscard]] std::size_t size() const;
+
+    [[nodiscard]] std::size_t shard_count() const;
+
+    /**
+     * Number of keys in each shard, for the tests and the benchmarks.
+     */
+    [[nodiscard]] std::vector<std::size_t> shard_sizes() const;
+
+    /**
+     * Number of rebuilds of the shard boundaries.
+     */
+    [[nodiscard]] std::size_t rebalance_count() const;
+
+private:
+    /** A shard larger than SKEW_FACTOR * average size triggers a rebalance. */
+    static constexpr std::size_t SKEW_FACTOR = 4;
+    /** Smaller shards are never rebalanced, a few keys can't make a skew. */
+    static constexpr std::size_t MIN_REBALANCE_SIZE = 1024;
+
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        OrderStatisticTree tree;
+    };
+
+    std::unique_ptr<Shard[]> shards;
+    /** Fenwick tree over the shard sizes, indexed from 1. */
+    std::unique_ptr<std::atomic<std::ptrdiff_t>[]> shard_counts;
+    std::size_t shards_number;
+    /** Shard i keeps keys from lower_bounds[i] up to lower_bounds[i + 1]. */
+    std::vector<int> lower_bounds;
+    std::atomic<std::size_t> total_size = 0;
+    std::atomic<std::size_t> rebalances = 0;
+    /** Shared by every operation, taken exclusively by a rebalance. */
+    mutable std::shared_mutex layout_mutex;
+
+    [[nodiscard]] std::size_t shard_of(int key) const;
+
+    void add_to_count(std::size_t shard, std::ptrdiff_t delta);
+
+    [[nodiscard]] std::size_t count_before(std::size_t shard) const;
+
+    /**
+     * Finds the shard of the k-th key, k becomes the rank inside the shard.
+     */
+    [[nodiscard]] std::size_t find_shard(std::size_t &k) const;
+
+    [[nodiscard]] bool is_skewed(std::size_t shard_size) const;
+
+    void rebalance();
+};
+
+#endif //ORDER_STATISTIC_TREE_SHARDEDKEYSTORAGE_H
@@ -0,0 +1,356 @@
+#include "WriteAheadLog.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unistd.h>
+#include <utility>
+
+#include "FileSync.h"
+#include "TreeSnapshot.h"
+
+static constexpr std::string_view SEGMENT_PREFIX = "wal-";
+static constexpr std::string_view SEGMENT_SUFFIX = ".log";
+static constexpr std::string_view CHECKPOINT_PREFIX = "checkpoint-";
+static constexpr std::string_view CHECKPOINT_SUFFIX = ".snapshot";
+
+static std::filesystem::path numbered_path(const std::filesystem::path &directory, std::string_view prefix,
+                                           std::uint64_t number, std::string_view suffix) {
+    std::string digits = std::to_string(number);
+    // Fixed width keeps the files in the order of their numbers in a listing.
+    digits.insert(0, 20 - std::min<std::size_t>(digits.size(), 20), '0');
+    return directory / (std::string(prefix) + digits + std::string(suffix));
+}
+
+static std::filesystem::path segment_path(const std::filesystem::path &directory, std::uint64_t number) {
+    return numbered_path(directory, SEGMENT_PREFIX, number, SEGMENT_SUFFIX);
+}
+
+static std::filesystem::path checkpoint_path(const std::filesystem::path &directory, std::uint64_t number) {
+    return numbered_path(directory, CHECKPOINT_PREFIX, number, CHECKPOINT_SUFFIX);
+}
+
+static bool parse_file_number(std::string_view name, std::string_view prefix, std::string_view suffix,
+                              std::uint64_t &number) {
+    if (!name.starts_with(prefix) || !name.ends_with(suffix))
+        return false;
+    const auto digits = name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+    const auto [end, error] = std::from_chars(digits.data(), digits.data() + digits.size(), number);
+    return error == std::errc() && end == digits.data() + digits.size() && !digits.empty();
+}
+
+/**
+ * Numbers of the segments and the checkpoints in a directory, in increasing order.
+ */
+struct LogFiles {
+    std::vector<std::uint64_t> segments;
+    std::vector<std::uint64_t> checkpoints;
+};
+
+static LogFiles list_log_files(const std::filesystem::path &directory) {
+    LogFiles files;
+    if (!std::filesystem::exists(directory))
+        return files;
+    for (const auto &entry: std::filesystem::directory_iterator(directory)) {
+        const auto name = entry.path().filename().string();
+        std::uint64_t number;
+        if (parse_file_number(name, SEGMENT_PREFIX, SEGMENT_SUFFIX, number))
+            files.segments.push_back(number);
+        else if (parse_file_number(name, CHECKPOINT_PREFIX, CHECKPOINT_SUFFIX, number))
+            files.checkpoints.push_back(number);
+    }
+    std::sort(files.segments.begin(), files.segments.end());
+    std::sort(files.checkpoints.begin(), files.checkpoints.end());
+    return files;
+}
+
+/**
+ * Record: the operation, 3 zero bytes and the key in little-endian.
+ */
+static void encode_record(LogOperation operation, int key, char *bytes) {
+    const auto value = static_cast<std::uint32_t>(key);
+    bytes[0] = static_cast<char>(operation);
+    bytes[1] = bytes[2] = bytes[3] = 0;
+    for (std::size_t i = 0; i < 4; i++)
+        bytes[4 + i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+}
+
+static bool decode_record(const char *bytes, LogRecord &record) {
+    const auto operation = static_cast<LogOperation>(bytes[0]);
+    if ((operation != LogOperation::INSERT && operation != LogOperation::ERASE) || bytes[1] || bytes[2] || bytes[3])
+        return false;
+    std::uint32_t value = 0;
+    for (std::size_t i = 0; i < 4; i++)
+        value |= static_cast<std::uint32_t>(static_cast<unsigned char>(bytes[4 + i])) << (8 * i);
+    record = LogRecord{operation, static_cast<int>(value)};
+    return true;
+}
+
+/**
+ * Appends the records of a segment up to the first torn or invalid one.
+ */
+static void read_segment(const std::filesystem::path &path, std::vector<LogRecord> &records) {
+    std::ifstream input(path, std::ios::binary);
+    if (!input)
+        throw std::runtime_error("Can't read the log segment " + path.string() + "!");
+    std::vector<char> bytes(1 << 16);
+    while (true) {
+        input.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        const auto read = static_cast<std::size_t>(input.gcount());
+        LogRecord record{};
+        for (std::size_t i = 0; i + 8 <= read; i += 8) {
+            if (!decode_record(bytes.data() + i, record))
+                return;
+            records.push_back(record);
+        }
+        if (read < bytes.size())
+            return;
+    }
+}
+
+/**
+ * Whether a checkpoint can be read: one written just before a crash may be incomplete or corrupted.
+ */
+static bool is_readable_checkpoint(const std::filesystem::path &path) {
+    std::ifstream input(path, std::ios::binary);
+    TreeSnapshotHeader header{};
+    if (!input.read(reinterpret_cast<char *>(&header), sizeof(header)))
+        return false;
+    try {
+        const auto layout = validate_snapshot_header<int>(header, std::filesystem::file_size(path));
+        const auto checksum = update_snapshot_checksum(SNAPSHOT_CHECKSUM_SEED, input,
+                                                       layout.file_size - sizeof(header));
+        return input && checksum == header.checksum;
+    } catch (const std::runtime_error &) {
+        return false;
+    }
+}
+
+/**
+ * Applies the changes to sorted keys. Changes of one key commute, so only their sum matters.
+ */
+static std::vector<int> apply_records(const std::vector<int> &keys, const std::vector<LogRecord> &records) {
+    std::vector<std::pair<int, long long>> deltas;
+    deltas.reserve(records.size());
+    for (const auto &record: records)
+        deltas.emplace_back(record.key, record.operation == LogOperation::INSERT ? 1 : -1);
+    std::sort(deltas.begin(), deltas.end());
+
+    std::vector<int> result;
+    result.reserve(keys.size() + deltas.size());
+    std::size_t i = 0;
+    std::size_t j = 0;
+    while (i < keys.size() || j < deltas.size()) {
+        const int key = j == deltas.size() || (i < keys.size() && keys[i] < deltas[j].first) ? keys[i]
+                                                                                              : deltas[j].first;
+        long long occurrences = 0;
+        for (; i < keys.size() && keys[i] == key; i++)
+            occurrences++;
+        for (; j < deltas.size() && deltas[j].first == key; j++)
+            occurrences += deltas[j].second;
+        if (occurrences < 0)
+            throw std::runtime_error("The log doesn't match the checkpoint!");
+        result.insert(result.end(), static_cast<std::size_t>(occurrences), key);
+    }
+    return result;
+}
+
+WriteAheadLog::WriteAheadLog(DurabilityOptions options) : options(std::move(options)) {
+    std::filesystem::create_directories(this->options.directory);
+    auto files = list_log_files(this->options.directory);
+    while (!files.checkpoints.empty() &&
+           !is_readable_checkpoint(checkpoint_path(this->options.directory, files.checkpoints.back()))) {
+        std::filesystem::remove(checkpoint_path(this->options.directory, files.checkpoints.back()));
+        files.checkpoints.pop_back();
+    }
+    checkpoint_number = files.checkpoints.empty() ? 0 : files.checkpoints.back();
+    has_unmerged_segments = std::any_of(files.segments.begin(), files.segments.end(),
+                                        [this](std::uint64_t number) { return number >= checkpoint_number; });
+    const std::uint64_t last_segment = files.segments.empty() ? 0 : files.segments.back();
+    buffer.reserve(WRITE_BUFFER_SIZE);
+    open_segment(std::max({last_segment + 1, checkpoint_number, std::uint64_t{1}}));
+    if (this->options.checkpoint_interval.count() > 0)
+        checkpoint_thread = std::thread(&WriteAheadLog::run_checkpoints, this);
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    {
+        std::lock_guard lock(stop_mutex);
+        stopping = true;
+    }
+    stop_condition.notify_all();
+    if (checkpoint_thread.joinable())
+        checkpoint_thread.join();
+    try {
+        sync();
+    } catch (const std::exception &ex) {
+        std::cerr << "Can't sync the log: " << ex.what() << std::endl;
+    }
+    ::close(segment_fd);
+}
+
+RecoveredKeys WriteAheadLog::recover(const std::filesystem::path &directory) {
+    const auto files = list_log_files(directory);
+    RecoveredKeys recovered;
+    std::uint64_t base = 0;
+    for (auto number = files.checkpoints.rbegin(); number != files.checkpoints.rend(); ++number) {
+        try {
+            recovered.checkpoint_keys = read_tree_snapshot<int>(checkpoint_path(directory, *number));
+            base = *number;
+            break;
+        } catch (const std::runtime_error &) {
+            // Not synced before the crash, the segments of the previous checkpoint are still there.
+        }
+    }
+    for (const auto number: files.segments) {
+        if (number >= base)
+            read_segment(segment_path(directory, number), recovered.tail);
+    }
+    return recovered;
+}
+
+void WriteAheadLog::append(LogOperation operation, int key) {
+    std::lock_guard lock(segment_mutex);
+    const auto size = buffer.size();
+    buffer.resize(size + RECORD_SIZE);
+    encode_record(operation, key, buffer.data() + size);
+    segment_records++;
+    unsynced_records++;
+    try {
+        if (options.sync_every == 0) {
+            if (buffer.size() >= WRITE_BUFFER_SIZE)
+                write_buffer();
+        } else if (unsynced_records >= options.sync_every) {
+            sync_segment();
+        }
+    } catch (...) {
+        discard_last_record();
+        throw;
+    }
+}
+
+void WriteAheadLog::sync() {
+    std::lock_guard lock(segment_mutex);
+    sync_segment();
+}
+
+void WriteAheadLog::checkpoint() {
+    std::lock_guard checkpoint_lock(checkpoint_mutex);
+    std::uint64_t last_closed;
+    {
+        std::lock_guard lock(segment_mutex);
+        if (segment_records == 0 && !has_unmerged_segments)
+            return;
+        sync_segment();
+        last_closed = segment_number;
+        open_segment(segment_number + 1);
+    }
+    has_unmerged_segments = true;
+
+    const auto &directory = options.directory;
+    std::vector<int> keys;
+    if (checkpoint_number > 0)
+        keys = read_tree_snapshot<int>(checkpoint_path(directory, checkpoint_number));
+    std::vector<LogRecord> records;
+    const auto files = list_log_files(directory);
+    for (const auto number: files.segments) {
+        if (number >= checkpoint_number && number <= last_closed)
+            read_segment(segment_path(directory, number), records);
+    }
+    const auto merged = apply_records(keys, records);
+
+    const auto next_number = last_closed + 1;
+    const auto path = checkpoint_path(directory, next_number);
+    // Synced before it is renamed and after, the old files are removed only when the checkpoint is durable.
+    write_tree_snapshot<int>(path, merged.begin(), merged.end(), merged.size());
+
+    for (const auto number: files.checkpoints) {
+        if (number < next_number)
+            std::filesystem::remove(checkpoint_path(directory, number));
+    }
+    for (const auto number: files.segments) {
+        if (number <= last_closed)
+            std::filesystem::remove(segment_path(directory, number));
+    }
+    checkpoint_number = next_number;
+    has_unmerged_segments = false;
+    finished_checkpoints++;
+}
+
+std::size_t WriteAheadLog::checkpoint_count() const {
+    return finished_checkpoints.load();
+}
+
+void WriteAheadLog::open_segment(std::uint64_t number) {
+    const auto path = segment_path(options.directory, number);
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0)
+        throw std::system_error(errno, std::generic_category(), "Can't open the log segment " + path.string());
+    if (segment_fd >= 0)
+        ::close(segment_fd);
+    segment_fd = fd;
+    segment_number = number;
+    segment_records = 0;
+    // The new file must survive a crash together with the records synced to it.
+    sync_path(options.directory, O_RDONLY | O_DIRECTORY);
+}
+
+void WriteAheadLog::write_buffer() {
+    std::size_t written = 0;
+    while (written < buffer.size()) {
+        const auto result = ::write(segment_fd, buffer.data() + written, buffer.size() - written);
+        if (result < 0) {
+            if (errno == EINTR)
+                continue;
+            const int error = errno;
+            // Only the bytes that are not in the file yet are kept, a retry doesn't write records twice.
+            buffer.erase(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(written));
+            throw std::system_error(error, std::generic_category(), "Can't write the log");
+        }
+        written += static_cast<std::size_t>(result);
+    }
+    buffer.clear();
+}
+
+void WriteAheadLog::discard_last_record() {
+    segment_records--;
+    unsynced_records--;
+    if (buffer.size() >= RECORD_SIZE) {
+        buffer.resize(buffer.size() - RECORD_SIZE);
+        return;
+    }
+    // The record reached the file in part or in whole. If the truncation fails too, recovery replays it.
+    const auto written = static_cast<off_t>(RECORD_SIZE - buffer.size());
+    buffer.clear();
+    const auto end = ::lseek(segment_fd, 0, SEEK_END);
+    if (end >= written)
+        static_cast<void>(::ftruncate(segment_fd, end - written));
+}
+
+void WriteAheadLog::sync_segment() {
+    write_buffer();
+    if (::fdatasync(segment_fd) != 0)
+        throw std::system_error(errno, std::generic_category(), "Can't sync the log");
+    unsynced_records = 0;
+}
+
+void WriteAheadLog::run_checkpoints() {
+    std::unique_lock lock(stop_mutex);
+    while (!stop_condition.wait_for(lock, options.checkpoint_interval, [this] { return stopping; })) {
+        lock.unlock();
+        try {
+            checkpoint();
+        } catch (const std::exception &ex) {
+            // The log still has every change, the next period retries.
+            std::cerr << "Checkpoint failed: " << ex.what() << std::endl;
+        }
+        lock.lock();
+    }
+}
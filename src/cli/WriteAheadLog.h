@@ -0,0 +1,139 @@
+#ifndef ORDER_STATISTIC_TREE_WRITEAHEADLOG_H
+#define ORDER_STATISTIC_TREE_WRITEAHEADLOG_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct DurabilityOptions {
+    /** Directory of the log segments and the checkpoints, it is created if it doesn't exist. */
+    std::filesystem::path directory;
+    /**
+     * The log is written and synced to the disk once per this many records (group commit),
+     * so a crash loses at most sync_every - 1 acknowledged changes. With 0 the records are written
+     * in 64 KiB chunks and synced only by sync() and the checkpoints.
+     */
+    std::size_t sync_every = 1;
+    /** Period of the background checkpoints, zero disables them. */
+    std::chrono::milliseconds checkpoint_interval{10'000};
+};
+
+enum class LogOperation : std::uint8_t {
+    INSERT = 1,
+    ERASE = 2
+};
+
+struct LogRecord {
+    LogOperation operation;
+    int key;
+};
+
+/**
+ * State found in the directory: the keys of the latest checkpoint and the changes logged after it.
+ */
+struct RecoveredKeys {
+    std::vector<int> checkpoint_keys;
+    std::vector<LogRecord> tail;
+};
+
+/**
+ * Append-only log of the successful changes of a key storage with incremental checkpoints.
+ *
+ * The log is split into segments wal-<n>.log of 8-byte records. A checkpoint rotates the segment,
+ * then merges the closed segments into the previous checkpoint and writes checkpoint-<n>.snapshot
+ * (a tree snapshot holding every change of the segments before n), so the storage itself is never
+ * copied or locked. The files the new checkpoint covers are removed once it is synced.
+ *
+ * Recovery takes the newest readable checkpoint and the segments from its number on,
+ * a torn record at the end of a segment and everything after it in that segment are ignored.
+ * Only successful changes are logged, so replaying them as a multiset gives the exact keys of any engine.
+ */
+class WriteAheadLog {
+public:
+    /**
+     * Opens the directory and starts a new segment after the existing ones.
+     * Throws std::system_error if a file can't be created.
+     */
+    explicit WriteAheadLog(DurabilityOptions options);
+
+    WriteAheadLog(const WriteAheadLog &) = delete;
+
+    WriteAheadLog &operator=(const WriteAheadLog &) = delete;
+
+    /**
+     * Stops the background checkpoints and syncs the log.
+     */
+    ~WriteAheadLog();
+
+    /**
+     * Reads the state of a directory without changing it.
+     */
+    static RecoveredKeys recover(const std::filesystem::path &directory);
+
+    /**
+     * Appends a record, then writes or syncs the log as the options say. Throws std::system_error
+     * if the log can't be written or synced, the record is taken back from the log then.
+     */
+    void append(LogOperation operation, int key);
+
+    /**
+     * Writes the buffered records and waits until the segment is on the disk.
+     */
+    void sync();
+
+    /**
+     * Checkpoints the changes logged so far, the background thread calls it periodically.
+     */
+    void checkpoint();
+
+    /**
+     * Number of the finished checkpoints, for the tests and the benchmarks.
+     */
+    [[nodiscard]] std::size_t checkpoint_count() const;
+
+private:
+    static constexpr std::size_t RECORD_SIZE = 8;
+    static constexpr std::size_t WRITE_BUFFER_SIZE = 1 << 16;
+
+    DurabilityOptions options;
+    /** Guards the current segment: the buffer, the file and its number. */
+    mutable std::mutex segment_mutex;
+    std::vector<char> buffer;
+    std::size_t unsynced_records = 0;
+    std::size_t segment_records = 0;
+    int segment_fd = -1;
+    std::uint64_t segment_number = 0;
+    /** Serializes the checkpoints, the merge runs without segment_mutex. */
+    std::mutex checkpoint_mutex;
+    std::uint64_t checkpoint_number = 0;
+    /** Closed segments not merged into a checkpoint yet, e.g. the segments of the previous run. */
+    bool has_unmerged_segments = false;
+    std::atomic<std::size_t> finished_checkpoints = 0;
+
+    std::mutex stop_mutex;
+    std::condition_variable stop_condition;
+    bool stopping = false;
+    std::thread checkpoint_thread;
+
+    void open_segment(std::uint64_t number);
+
+    void write_buffer();
+
+    /**
+     * Takes back the last appended record after a failed write or sync: it is dropped from the buffer,
+     * or cut off the segment if it already reached the file.
+     */
+    void discard_last_record();
+
+    void sync_segment();
+
+    void run_checkpoints();
+};
+
+#endif //ORDER_STATISTIC_TREE_WRITEAHEADLOG_H
@@ -1,5 +1,19 @@
-int run();
+#include <iostream>
+#include <stdexcept>
 
-int main() {
-    return run();
+#include "CliOptions.h"
+
+int run(const CliOptions &options);
+
+int main(int argc, char *argv[]) {
+    // The CLI uses only the C++ streams, so they may keep their own buffers.
+    std::ios::sync_with_stdio(false);
+    CliOptions options;
+    try {
+        options = parse_cli_options(argc, argv);
+    } catch (const std::invalid_argument &ex) {
+        std::cerr << ex.what() << "\n" << cli_usage();
+        return 1;
+    }
+    return run(options);
 }
@@ -0,0 +1,8 @@
+#include "EraseKeyQuery.h"
+
+#include "Query.h"
+
+void EraseKeyQuery::execute(KeyStorage &storage, std::string &output) const {
+    const auto status = storage.try_erase_key(key);
+    output += status == StorageStatus::OK ? "Successfully deleted." : status_message(status);
+}
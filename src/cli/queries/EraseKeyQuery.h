@@ -0,0 +1,17 @@
+#ifndef ORDER_STATISTIC_TREE_ERASEKEYQUERY_H
+#define ORDER_STATISTIC_TREE_ERASEKEYQUERY_H
+
+#include <string>
+
+#include "KeyStorage.h"
+
+struct EraseKeyQuery {
+    int key = 0;
+
+    /**
+     * Appends the response to output.
+     */
+    void execute(KeyStorage &storage, std::string &output) const;
+};
+
+#endif //ORDER_STATISTIC_TREE_ERASEKEYQUERY_H
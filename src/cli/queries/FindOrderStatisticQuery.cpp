@@ -1,21 +1,12 @@
 #include "FindOrderStatisticQuery.h"
 
-#include <string>
-#include <exception>
-#include <sstream>
+#include "Query.h"
 
-FindOrderStatisticQuery::FindOrderStatisticQuery(KeyStorage &storage, const std::string &args) :
-        Query(storage) {
-    std::stringstream stream(args);
-    stream >> k;
-    if (stream.fail())
-        throw std::invalid_argument("Expected integer argument.");
-}
-
-std::string FindOrderStatisticQuery::execute() {
-    try {
-        return std::to_string(storage.find_order_statistic(k));
-    } catch (const std::exception &ex) {
-        return ex.what();
-    }
+void FindOrderStatisticQuery::execute(KeyStorage &storage, std::string &output) const {
+    int key;
+    const auto status = storage.try_find_order_statistic(static_cast<std::size_t>(k), key);
+    if (status == StorageStatus::OK)
+        append_integer(output, key);
+    else
+        output += status_message(status);
 }
@@ -1,18 +1,17 @@
 #ifndef ORDER_STATISTIC_TREE_FINDORDERSTATISTICQUERY_H
 #define ORDER_STATISTIC_TREE_FINDORDERSTATISTICQUERY_H
 
-#include "KeyStorage.h"
-#include "Query.h"
-
-class FindOrderStatisticQuery : public Query {
-public:
-    FindOrderStatisticQuery(KeyStorage &storage, const std::string &args);
+#include <string>
 
-    std::string execute() override;
+#include "KeyStorage.h"
 
-private:
+struct FindOrderStatisticQuery {
     ssize_t k = 0;
-};
 
+    /**
+     * Appends the response to output.
+     */
+    void execute(KeyStorage &storage, std::string &output) const;
+};
 
 #endif //ORDER_STATISTIC_TREE_FINDORDERSTATISTICQUERY_H
@@ -1,21 +1,7 @@
 #include "GetLessCountQuery.h"
 
-#include <string>
-#include <exception>
-#include <sstream>
+#include "Query.h"
 
-GetLessCountQuery::GetLessCountQuery(KeyStorage &storage, const std::string &args) :
-        Query(storage) {
-    std::stringstream stream(args);
-    stream >> key;
-    if (stream.fail())
-        throw std::invalid_argument("Expected integer argument.");
+void GetLessCountQuery::execute(KeyStorage &storage, std::string &output) const {
+    append_integer(output, storage.get_less_count(key));
 }
-
-std::string GetLessCountQuery::execute() {
-    try {
-        return std::to_string(storage.get_less_count(key));
-    } catch (const std::exception &ex) {
-        return ex.what();
-    }
-}
\ No newline at end of file
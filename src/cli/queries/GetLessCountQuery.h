@@ -1,18 +1,17 @@
 #ifndef ORDER_STATISTIC_TREE_GETLESSCOUNTQUERY_H
 #define ORDER_STATISTIC_TREE_GETLESSCOUNTQUERY_H
 
-#include "Query.h"
-#include "KeyStorage.h"
-
-class GetLessCountQuery : public Query {
-public:
-    GetLessCountQuery(KeyStorage &storage, const std::string &args);
+#include <string>
 
-    std::string execute() override;
+#include "KeyStorage.h"
 
-private:
+struct GetLessCountQuery {
     int key = 0;
-};
 
+    /**
+     * Appends the response to output.
+     */
+    void execute(KeyStorage &storage, std::string &output) const;
+};
 
 #endif //ORDER_STATISTIC_TREE_GETLESSCOUNTQUERY_H
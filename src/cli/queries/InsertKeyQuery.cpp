@@ -1,23 +1,8 @@
 #include "InsertKeyQuery.h"
 
-#include <string>
-#include <stdexcept>
-#include <sstream>
+#include "Query.h"
 
-
-InsertKeyQuery::InsertKeyQuery(KeyStorage &storage, const std::string &args) :
-        Query(storage) {
-    std::stringstream stream(args);
-    stream >> key;
-    if (stream.fail())
-        throw std::invalid_argument("Expected integer argument.");
+void InsertKeyQuery::execute(KeyStorage &storage, std::string &output) const {
+    const auto status = storage.try_insert_key(key);
+    output += status == StorageStatus::OK ? "Successfully added." : status_message(status);
 }
-
-std::string InsertKeyQuery::execute() {
-    try {
-        storage.insert_key(key);
-        return "Successfully added.";
-    } catch (const std::exception &ex) {
-        return ex.what();
-    }
-}
\ No newline at end of file
@@ -1,17 +1,17 @@
 #ifndef ORDER_STATISTIC_TREE_INSERTKEYQUERY_H
 #define ORDER_STATISTIC_TREE_INSERTKEYQUERY_H
 
-#include "Query.h"
-#include "KeyStorage.h"
-
-class InsertKeyQuery : public Query {
-public:
-    InsertKeyQuery(KeyStorage &storage, const std::string &args);
+#include <string>
 
-    std::string execute() override;
+#include "KeyStorage.h"
 
-private:
+struct InsertKeyQuery {
     int key = 0;
+
+    /**
+     * Appends the response to output.
+     */
+    void execute(KeyStorage &storage, std::string &output) const;
 };
 
 #endif //ORDER_STATISTIC_TREE_INSERTKEYQUERY_H
@@ -1,7 +1,47 @@
 #include "Query.h"
 
-Query::Query(KeyStorage &storage) : storage(storage) {}
+#include <algorithm>
+#include <type_traits>
 
-std::string Query::execute() {
-    return "";
+void InvalidQuery::execute(KeyStorage &, std::string &output) const {
+    output += message;
+}
+
+/**
+ * Splits off the next whitespace-separated token like operator>> of a stream.
+ */
+static std::string_view next_token(std::string_view &line) {
+    constexpr std::string_view whitespace = " \t\n\v\f\r";
+    const auto first = std::min(line.find_first_not_of(whitespace), line.size());
+    const auto last = std::min(line.find_first_of(whitespace, first), line.size());
+    const auto token = line.substr(first, last - first);
+    line.remove_prefix(last);
+    return token;
+}
+
+template<class KeyQuery>
+static Query parse_argument(std::string_view args) {
+    KeyQuery query;
+    if constexpr (std::is_same_v<KeyQuery, FindOrderStatisticQuery>) {
+        if (!parse_integer_argument(args, query.k))
+            return InvalidQuery{"Expected integer argument."};
+    } else {
+        if (!parse_integer_argument(args, query.key))
+            return InvalidQuery{"Expected integer argument."};
+    }
+    return query;
+}
+
+Query parse_query(std::string_view line) {
+    const auto name = next_token(line);
+    const auto args = next_token(line);
+    if (name == "k")
+        return parse_argument<InsertKeyQuery>(args);
+    else if (name == "d")
+        return parse_argument<EraseKeyQuery>(args);
+    else if (name == "m")
+        return parse_argument<FindOrderStatisticQuery>(args);
+    else if (name == "n")
+        return parse_argument<GetLessCountQuery>(args);
+    return InvalidQuery{"Unknown query."};
 }
@@ -1,20 +1,55 @@
 #ifndef ORDER_STATISTIC_TREE_QUERY_H
 #define ORDER_STATISTIC_TREE_QUERY_H
 
+#include <charconv>
 #include <string>
+#include <string_view>
+#include <variant>
 
+#include "EraseKeyQuery.h"
+#include "FindOrderStatisticQuery.h"
+#include "GetLessCountQuery.h"
+#include "InsertKeyQuery.h"
 #include "KeyStorage.h"
 
-class Query {
-public:
-    explicit Query(KeyStorage &storage);
+/**
+ * Line that is not a valid query, its response is the error message.
+ */
+struct InvalidQuery {
+    std::string_view message;
 
-    virtual ~Query() = default;
+    void execute(KeyStorage &storage, std::string &output) const;
+};
 
-    virtual std::string execute();
+/**
+ * Parsed query, it is held by value and executed without virtual calls.
+ */
+using Query = std::variant<InsertKeyQuery, EraseKeyQuery, FindOrderStatisticQuery, GetLessCountQuery, InvalidQuery>;
 
-protected:
-    KeyStorage &storage;
-};
+/**
+ * Parses a query line: the query name and an integer argument separated by whitespace,
+ * the rest of the line is ignored. Doesn't allocate and doesn't throw.
+ */
+Query parse_query(std::string_view line);
+
+/**
+ * Parses an integer argument without allocation, like operator>> of a stream: an optional sign,
+ * then digits, the rest of the argument is ignored. Returns false if there are no digits
+ * or the value is out of range.
+ */
+template<class Integer>
+bool parse_integer_argument(std::string_view args, Integer &value) {
+    if (args.size() > 1 && args[0] == '+' && args[1] != '-')
+        args.remove_prefix(1);
+    const auto [end, error] = std::from_chars(args.data(), args.data() + args.size(), value);
+    return error == std::errc();
+}
+
+template<class Integer>
+void append_integer(std::string &output, Integer value) {
+    char digits[24];
+    const auto [end, error] = std::to_chars(digits, digits + sizeof(digits), value);
+    output.append(digits, end);
+}
 
 #endif //ORDER_STATISTIC_TREE_QUERY_H
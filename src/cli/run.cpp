@@ -1,18 +1,85 @@
+#include <filesystem>
 #include <iostream>
-#include <variant>
-#include <stdexcept>
-#include <optional>
+#include <memory>
+#include <string>
+#include <unistd.h>
 
+#include "BinaryProtocol.h"
+#include "CliOptions.h"
 #include "KeyStorage.h"
+#include "LineReader.h"
 #include "QueryExecutor.h"
 
-int run() {
-    using std::cin, std::cout, std::endl;
-    KeyStorage storage;
+/** Responses are written in chunks of about this size. */
+static constexpr std::size_t OUTPUT_FLUSH_THRESHOLD = 1 << 16;
+
+static void write_output(std::string &output) {
+    std::cout.write(output.data(), static_cast<std::streamsize>(output.size()));
+    output.clear();
+}
+
+static int run_text_mode(KeyStorage &storage) {
     QueryExecutor executor(storage);
-    std::string query;
-    while (getline(std::cin, query)) {
-        std::cout << executor.execute_query(query) << std::endl;
+    // A terminal needs every query answered at once: input is read by lines and every response is flushed.
+    const bool interactive = isatty(STDIN_FILENO) != 0 || isatty(STDOUT_FILENO) != 0;
+    LineReader reader(std::cin, isatty(STDIN_FILENO) != 0);
+    std::string_view query;
+    std::string output;
+    output.reserve(OUTPUT_FLUSH_THRESHOLD + 256);
+    while (reader.next_line(query)) {
+        executor.execute_query(query, output);
+        output += '\n';
+        if (interactive) {
+            write_output(output);
+            std::cout.flush();
+        } else if (output.size() >= OUTPUT_FLUSH_THRESHOLD) {
+            write_output(output);
+        }
     }
+    write_output(output);
+    std::cout.flush();
     return 0;
-}
\ No newline at end of file
+}
+
+static int run_binary_mode(KeyStorage &storage) {
+    if (run_binary_queries(storage, std::cin, std::cout))
+        return 0;
+    std::cerr << "The input ends with an incomplete record." << std::endl;
+    return 1;
+}
+
+static std::unique_ptr<KeyStorage> open_storage(const CliOptions &options) {
+    if (options.wal_directory.empty())
+        return std::make_unique<KeyStorage>(options.engine);
+    DurabilityOptions durability;
+    durability.directory = options.wal_directory;
+    durability.sync_every = options.sync_every;
+    return std::make_unique<KeyStorage>(options.engine, durability);
+}
+
+int run(const CliOptions &options) {
+    std::unique_ptr<KeyStorage> storage;
+    try {
+        storage = open_storage(options);
+        if (!options.snapshot_path.empty() && std::filesystem::exists(options.snapshot_path))
+            storage->load(options.snapshot_path);
+    } catch (const std::exception &ex) {
+        std::cerr << "Can't load the keys: " << ex.what() << std::endl;
+        return 1;
+    }
+    const int result = options.binary ? run_binary_mode(*storage) : run_text_mode(*storage);
+    try {
+        if (!options.snapshot_path.empty())
+            storage->save(options.snapshot_path);
+        if (const auto log = storage->write_ahead_log())
+            log->sync();
+    } catch (const std::exception &ex) {
+        std::cerr << "Can't save the keys: " << ex.what() << std::endl;
+        return 1;
+    }
+    return result;
+}
+
+int run() {
+    return run(CliOptions());
+}
@@ -0,0 +1,96 @@
+#ifndef ORDER_STATISTIC_TREE_AUGMENTATION_H
+#define ORDER_STATISTIC_TREE_AUGMENTATION_H
+
+#include <concepts>
+#include <cstddef>
+#include <limits>
+
+/**
+ * Monoid kept by every node of a tree over its subtree, besides the count.
+ *
+ * from_key gives the value of one key with its multiplicity, combine must be associative
+ * with identity() as the neutral element. The policy is stateless, all functions are static.
+ */
+template<class Augmentation, class Key>
+concept TreeAugmentation = requires(const Key &key, const typename Augmentation::value_type &value) {
+    { Augmentation::identity() } -> std::convertible_to<typename Augmentation::value_type>;
+    { Augmentation::from_key(key, std::size_t(1)) } -> std::convertible_to<typename Augmentation::value_type>;
+    { Augmentation::combine(value, value) } -> std::convertible_to<typename Augmentation::value_type>;
+};
+
+/**
+ * Keeps nothing. Its value is empty, so the nodes don't grow and the tree skips the updates.
+ */
+struct NoAugmentation {
+    struct value_type {
+    };
+
+    static value_type identity() {
+        return {};
+    }
+
+    template<class Key>
+    static value_type from_key(const Key &, std::size_t) {
+        return {};
+    }
+
+    static value_type combine(value_type, value_type) {
+        return {};
+    }
+};
+
+template<class Value>
+struct SumAugmentation {
+    using value_type = Value;
+
+    static value_type identity() {
+        return Value();
+    }
+
+    template<class Key>
+    static value_type from_key(const Key &key, std::size_t multiplicity) {
+        return static_cast<Value>(key) * static_cast<Value>(multiplicity);
+    }
+
+    static value_type combine(const value_type &first, const value_type &second) {
+        return first + second;
+    }
+};
+
+template<class Value>
+struct MinAugmentation {
+    using value_type = Value;
+
+    static value_type identity() {
+        return std::numeric_limits<Value>::max();
+    }
+
+    template<class Key>
+    static value_type from_key(const Key &key, std::size_t) {
+        return static_cast<Value>(key);
+    }
+
+    static value_type combine(const value_type &first, const value_type &second) {
+        return second < first ? second : first;
+    }
+};
+
+template<class Value>
+struct MaxAugmentation {
+    using value_type = Value;
+
+    static value_type identity() {
+        return std::numeric_limits<Value>::lowest();
+    }
+
+    template<class Key>
+    static value_type from_key(const Key &key, std::size_t) {
+        return static_cast<Value>(key);
+    }
+
+    static value_type combine(const value_type &first, const value_type &second) {
+        return first < second ? second : first;
+    }
+};
+
+#endif //ORDER_STATISTIC_TREE_AUGMENTATION_H
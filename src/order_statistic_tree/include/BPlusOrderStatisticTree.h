@@ -0,0 +1,525 @@
+#ifndef ORDER_STATISTIC_TREE_BPLUSORDERSTATISTICTREE_H
+#define ORDER_STATISTIC_TREE_BPLUSORDERSTATISTICTREE_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+
+#include "SimdKernels.h"
+
+/**
+ * B+-tree with the OrderStatisticTree interface.
+ *
+ * Keys live in the leaves, every inner node keeps the subtree count of each child next to
+ * the separators, so a rank query reads about log_B(n) nodes of a few cache lines each.
+ * The separator keys[i] of an inner node is a lower bound of the keys in children[i + 1]
+ * and an upper bound of the keys in children[i].
+ * Searches inside a node are linear scans done by the SIMD kernels.
+ * Leaves are linked in key order for iteration.
+ */
+template<std::size_t NodeCapacity = 32>
+class BPlusOrderStatisticTree {
+    static_assert(NodeCapacity >= 16 && NodeCapacity <= 64, "Node must hold from 16 to 64 keys!");
+
+protected:
+    struct Node {
+        const bool is_leaf;
+        /** Number of keys in a leaf or number of children in an inner node. */
+        std::uint32_t size = 0;
+
+        explicit Node(bool is_leaf) : is_leaf(is_leaf) {}
+    };
+
+    struct LeafNode : Node {
+        std::array<int, NodeCapacity> keys{};
+        LeafNode *next = nullptr;
+
+        LeafNode() : Node(true) {}
+    };
+
+    struct InnerNode : Node {
+        std::array<int, NodeCapacity - 1> keys{};
+        std::array<std::size_t, NodeCapacity> counts{};
+        std::array<Node *, NodeCapacity> children{};
+
+        InnerNode() : Node(false) {}
+    };
+
+    /** Right half of a split node and the separator before it. */
+    struct Split {
+        int separator = 0;
+        Node *right = nullptr;
+    };
+
+    Node *root = nullptr;
+    std::size_t count = 0;
+
+public:
+    /**
+     * Forward iterator over the keys in increasing order. Keys are immutable.
+     */
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const int *;
+        using reference = const int &;
+
+        iterator() = default;
+
+        reference operator*() const {
+            return leaf->keys[index];
+        }
+
+        pointer operator->() const {
+            return &leaf->keys[index];
+        }
+
+        iterator &operator++() {
+            if (++index == leaf->size) {
+                leaf = leaf->next;
+                index = 0;
+            }
+            return *this;
+        }
+
+        iterator operator++(int) {
+            auto old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const iterator &other) const = default;
+
+    private:
+        friend class BPlusOrderStatisticTree;
+
+        const LeafNode *leaf = nullptr;
+        std::size_t index = 0;
+
+        iterator(const LeafNode *leaf, std::size_t index) : leaf(leaf), index(index) {}
+    };
+
+    using const_iterator = iterator;
+
+    BPlusOrderStatisticTree() = default;
+
+    BPlusOrderStatisticTree(const BPlusOrderStatisticTree &other) : count(other.count) {
+        LeafNode *previous_leaf = nullptr;
+        root = copy_subtree(other.root, previous_leaf);
+    }
+
+    BPlusOrderStatisticTree(BPlusOrderStatisticTree &&other) noexcept: BPlusOrderStatisticTree() {
+        swap(*this, other);
+    }
+
+    BPlusOrderStatisticTree &operator=(BPlusOrderStatisticTree tree) {
+        swap(*this, tree);
+        return *this;
+    }
+
+    ~BPlusOrderStatisticTree() {
+        destroy_subtree(root);
+    }
+
+    void clear() {
+        destroy_subtree(root);
+        root = nullptr;
+        count = 0;
+    }
+
+    [[nodiscard]] iterator begin() const {
+        if (!root)
+            return end();
+        const Node *cur = root;
+        while (!cur->is_leaf)
+            cur = static_cast<const InnerNode *>(cur)->children[0];
+        return iterator(static_cast<const LeafNode *>(cur), 0);
+    }
+
+    [[nodiscard]] iterator end() const {
+        return iterator();
+    }
+
+    [[nodiscard]] iterator find(int key) const {
+        if (!root)
+            return end();
+        const Node *cur = root;
+        while (!cur->is_leaf) {
+            const auto inner = static_cast<const InnerNode *>(cur);
+            cur = inner->children[upper_child_index(inner, key)];
+        }
+        const auto leaf = static_cast<const LeafNode *>(cur);
+        const auto i = count_less(leaf->keys.data(), leaf->size, key);
+        return i < leaf->size && leaf->keys[i] == key ? iterator(leaf, i) : end();
+    }
+
+    /**
+     * Descends once, updating the counts on the way back up only if the key was added.
+     */
+    std::pair<iterator, bool> insert(int key) {
+        if (!root)
+            root = new LeafNode();
+
+        Split split;
+        iterator position;
+        if (!insert(root, key, split, position))
+            return {position, false};
+        if (split.right) {
+            auto new_root = new InnerNode();
+            new_root->size = 2;
+            new_root->keys[0] = split.separator;
+            new_root->children[0] = root;
+            new_root->children[1] = split.right;
+            new_root->counts[0] = subtree_count(root);
+            new_root->counts[1] = subtree_count(split.right);
+            root = new_root;
+        }
+        count++;
+        return {position, true};
+    }
+
+    /**
+     * Returns the number of erased keys: 0 or 1.
+     */
+    std::size_t erase(int key) {
+        if (!root || !erase(root, key))
+            return 0;
+        count--;
+        if (root->is_leaf && root->size == 0) {
+            delete static_cast<LeafNode *>(root);
+            root = nullptr;
+        } else if (!root->is_leaf && root->size == 1) {
+            const auto old_root = static_cast<InnerNode *>(root);
+            root = old_root->children[0];
+            delete old_root;
+        }
+        return 1;
+    }
+
+    /**
+     * Erases the k-th smallest key and returns it.
+     */
+    int erase_kth(std::size_t k) {
+        if (k == 0 || k > size())
+            throw std::logic_error("k must be from 1 to tree size!");
+        const int key = find_order_statistic(k);
+        erase(key);
+        return key;
+    }
+
+    [[nodiscard]] bool contains(int key) const {
+        return find(key) != end();
+    }
+
+    [[nodiscard]] bool empty() const {
+        return count == 0;
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return count;
+    }
+
+    [[nodiscard]] int find_order_statistic(std::size_t k) const {
+        if (k == 0 || k > size())
+            throw std::logic_error("k must be from 1 to tree size!");
+        const Node *cur = root;
+        while (!cur->is_leaf) {
+            const auto inner = static_cast<const InnerNode *>(cur);
+            cur = inner->children[find_rank_child(inner->counts.data(), inner->size, k)];
+        }
+        return static_cast<const LeafNode *>(cur)->keys[k - 1];
+    }
+
+    [[nodiscard]] std::size_t less_count(int key) const {
+        if (!root)
+            return 0;
+        std::size_t lower_count = 0;
+        const Node *cur = root;
+        while (!cur->is_leaf) {
+            const auto inner = static_cast<const InnerNode *>(cur);
+            const auto i = count_less(inner->keys.data(), inner->size - 1, key);
+            for (std::size_t j = 0; j < i; j++)
+                lower_count += inner->counts[j];
+            cur = inner->children[i];
+        }
+        const auto leaf = static_cast<const LeafNode *>(cur);
+        return lower_count + count_less(leaf->keys.data(), leaf->size, key);
+    }
+
+    friend void swap(BPlusOrderStatisticTree &first, BPlusOrderStatisticTree &second) noexcept {
+        using std::swap;
+        swap(first.root, second.root);
+        swap(first.count, second.count);
+    }
+
+private:
+    /**
+     * Index of the child that may contain the key.
+     */
+    static std::size_t upper_child_index(const InnerNode *inner, int key) {
+        const std::size_t keys_count = inner->size - 1;
+        const auto i = count_less(inner->keys.data(), keys_count, key);
+        return i < keys_count && inner->keys[i] == key ? i + 1 : i;
+    }
+
+    static std::size_t subtree_count(const Node *node) {
+        if (node->is_leaf)
+            return node->size;
+        const auto inner = static_cast<const InnerNode *>(node);
+        std::size_t result = 0;
+        for (std::size_t i = 0; i < inner->size; i++)
+            result += inner->counts[i];
+        return result;
+    }
+
+    /**
+     * Returns false if the key already exists. A split of the node is reported through split,
+     * the position of the key through position.
+     */
+    static bool insert(Node *node, int key, Split &split, iterator &position) {
+        if (node->is_leaf)
+            return insert_into_leaf(static_cast<LeafNode *>(node), key, split, position);
+
+        const auto inner = static_cast<InnerNode *>(node);
+        const auto i = upper_child_index(inner, key);
+        Split child_split;
+        if (!insert(inner->children[i], key, child_split, position))
+            return false;
+        if (!child_split.right) {
+            inner->counts[i]++;
+            return true;
+        }
+        inner->counts[i] = subtree_count(inner->children[i]);
+        insert_child(inner, i + 1, child_split, split);
+        return true;
+    }
+
+    static bool insert_into_leaf(LeafNode *leaf, int key, Split &split, iterator &position) {
+        const auto keys_end = leaf->keys.begin() + leaf->size;
+        const auto i = count_less(leaf->keys.data(), leaf->size, key);
+        const auto key_position = leaf->keys.begin() + i;
+        position = iterator(leaf, i);
+        if (key_position != keys_end && *key_position == key)
+            return false;
+
+        if (leaf->size < NodeCapacity) {
+            std::copy_backward(key_position, keys_end, keys_end + 1);
+            *key_position = key;
+            leaf->size++;
+            return true;
+        }
+
+        std::array<int, NodeCapacity + 1> all_keys;
+        std::copy(leaf->keys.begin(), key_position, all_keys.begin());
+        all_keys[i] = key;
+        std::copy(key_position, keys_end, all_keys.begin() + i + 1);
+
+        const std::size_t left_size = (NodeCapacity + 1) / 2;
+        const auto right = new LeafNode();
+        std::copy(all_keys.begin(), all_keys.begin() + left_size, leaf->keys.begin());
+        std::copy(all_keys.begin() + left_size, all_keys.end(), right->keys.begin());
+        leaf->size = left_size;
+        right->size = NodeCapacity + 1 - left_size;
+        right->next = leaf->next;
+        leaf->next = right;
+        if (i >= left_size)
+            position = iterator(right, i - left_size);
+        split.separator = right->keys[0];
+        split.right = right;
+        return true;
+    }
+
+    /**
+     * Inserts the right half of a split child at position i, splitting the inner node if it is full.
+     */
+    static void insert_child(InnerNode *inner, std::size_t i, const Split &child_split, Split &split) {
+        const std::size_t child_count = subtree_count(child_split.right);
+        if (inner->size < NodeCapacity) {
+            std::copy_backward(inner->keys.begin() + i - 1, inner->keys.begin() + inner->size - 1,
+                               inner->keys.begin() + inner->size);
+            std::copy_backward(inner->counts.begin() + i, inner->counts.begin() + inner->size,
+                               inner->counts.begin() + inner->size + 1);
+            std::copy_backward(inner->children.begin() + i, inner->children.begin() + inner->size,
+                               inner->children.begin() + inner->size + 1);
+            inner->keys[i - 1] = child_split.separator;
+            inner->counts[i] = child_count;
+            inner->children[i] = child_split.right;
+            inner->size++;
+            return;
+        }
+
+        std::array<int, NodeCapacity> all_keys;
+        std::array<std::size_t, NodeCapacity + 1> all_counts;
+        std::array<Node *, NodeCapacity + 1> all_children;
+        std::copy(inner->keys.begin(), inner->keys.begin() + i - 1, all_keys.begin());
+        all_keys[i - 1] = child_split.separator;
+        std::copy(inner->keys.begin() + i - 1, inner->keys.end(), all_keys.begin() + i);
+        std::copy(inner->counts.begin(), inner->counts.begin() + i, all_counts.begin());
+        all_counts[i] = child_count;
+        std::copy(inner->counts.begin() + i, inner->counts.end(), all_counts.begin() + i + 1);
+        std::copy(inner->children.begin(), inner->children.begin() + i, all_children.begin());
+        all_children[i] = child_split.right;
+        std::copy(inner->children.begin() + i, inner->children.end(), all_children.begin() + i + 1);
+
+        const std::size_t left_size = (NodeCapacity + 1) / 2;
+        const std::size_t right_size = NodeCapacity + 1 - left_size;
+        const auto right = new InnerNode();
+        std::copy(all_keys.begin(), all_keys.begin() + left_size - 1, inner->keys.begin());
+        std::copy(all_keys.begin() + left_size, all_keys.end(), right->keys.begin());
+        std::copy(all_counts.begin(), all_counts.begin() + left_size, inner->counts.begin());
+        std::copy(all_counts.begin() + left_size, all_counts.end(), right->counts.begin());
+        std::copy(all_children.begin(), all_children.begin() + left_size, inner->children.begin());
+        std::copy(all_children.begin() + left_size, all_children.end(), right->children.begin());
+        inner->size = left_size;
+        right->size = right_size;
+        split.separator = all_keys[left_size - 1];
+        split.right = right;
+    }
+
+    static bool erase(Node *node, int key) {
+        if (node->is_leaf) {
+            const auto leaf = static_cast<LeafNode *>(node);
+            const auto i = count_less(leaf->keys.data(), leaf->size, key);
+            if (i == leaf->size || leaf->keys[i] != key)
+                return false;
+            std::copy(leaf->keys.begin() + i + 1, leaf->keys.begin() + leaf->size, leaf->keys.begin() + i);
+            leaf->size--;
+            return true;
+        }
+
+        const auto inner = static_cast<InnerNode *>(node);
+        const auto i = upper_child_index(inner, key);
+        if (!erase(inner->children[i], key))
+            return false;
+        inner->counts[i]--;
+        if (inner->children[i]->size < NodeCapacity / 2)
+            rebalance_children(inner, i + 1 < inner->size ? i : i - 1);
+        return true;
+    }
+
+    /**
+     * Redistributes the keys of the children i and i + 1 evenly or merges them into the child i
+     * if they fit into one node.
+     */
+    static void rebalance_children(InnerNode *inner, std::size_t i) {
+        const auto left = inner->children[i];
+        const auto right = inner->children[i + 1];
+        const bool merged = left->is_leaf
+                            ? rebalance_leaves(static_cast<LeafNode *>(left), static_cast<LeafNode *>(right),
+                                               inner->keys[i])
+                            : rebalance_inner_nodes(static_cast<InnerNode *>(left),
+                                                    static_cast<InnerNode *>(right), inner->keys[i]);
+        if (!merged) {
+            inner->counts[i] = subtree_count(left);
+            inner->counts[i + 1] = subtree_count(right);
+            return;
+        }
+        inner->counts[i] += inner->counts[i + 1];
+        std::copy(inner->keys.begin() + i + 1, inner->keys.begin() + inner->size - 1, inner->keys.begin() + i);
+        std::copy(inner->counts.begin() + i + 2, inner->counts.begin() + inner->size,
+                  inner->counts.begin() + i + 1);
+        std::copy(inner->children.begin() + i + 2, inner->children.begin() + inner->size,
+                  inner->children.begin() + i + 1);
+        inner->size--;
+    }
+
+    /**
+     * Returns true if the right leaf was merged into the left one and deleted.
+     */
+    static bool rebalance_leaves(LeafNode *left, LeafNode *right, int &separator) {
+        const std::size_t total = left->size + right->size;
+        std::array<int, 2 * NodeCapacity> all_keys;
+        std::copy(left->keys.begin(), left->keys.begin() + left->size, all_keys.begin());
+        std::copy(right->keys.begin(), right->keys.begin() + right->size, all_keys.begin() + left->size);
+        if (total <= NodeCapacity) {
+            std::copy(all_keys.begin(), all_keys.begin() + total, left->keys.begin());
+            left->size = total;
+            left->next = right->next;
+            delete right;
+            return true;
+        }
+        const std::size_t left_size = total / 2;
+        std::copy(all_keys.begin(), all_keys.begin() + left_size, left->keys.begin());
+        std::copy(all_keys.begin() + left_size, all_keys.begin() + total, right->keys.begin());
+        left->size = left_size;
+        right->size = total - left_size;
+        separator = right->keys[0];
+        return false;
+    }
+
+    /**
+     * The separator between the nodes is pulled down, so the children stay ordered.
+     * Returns true if the right node was merged into the left one and deleted.
+     */
+    static bool rebalance_inner_nodes(InnerNode *left, InnerNode *right, int &separator) {
+        const std::size_t total = left->size + right->size;
+        std::array<int, 2 * NodeCapacity - 1> all_keys;
+        std::array<std::size_t, 2 * NodeCapacity> all_counts;
+        std::array<Node *, 2 * NodeCapacity> all_children;
+        std::copy(left->keys.begin(), left->keys.begin() + left->size - 1, all_keys.begin());
+        all_keys[left->size - 1] = separator;
+        std::copy(right->keys.begin(), right->keys.begin() + right->size - 1, all_keys.begin() + left->size);
+        std::copy(left->counts.begin(), left->counts.begin() + left->size, all_counts.begin());
+        std::copy(right->counts.begin(), right->counts.begin() + right->size, all_counts.begin() + left->size);
+        std::copy(left->children.begin(), left->children.begin() + left->size, all_children.begin());
+        std::copy(right->children.begin(), right->children.begin() + right->size,
+                  all_children.begin() + left->size);
+        if (total <= NodeCapacity) {
+            std::copy(all_keys.begin(), all_keys.begin() + total - 1, left->keys.begin());
+            std::copy(all_counts.begin(), all_counts.begin() + total, left->counts.begin());
+            std::copy(all_children.begin(), all_children.begin() + total, left->children.begin());
+            left->size = total;
+            delete right;
+            return true;
+        }
+        const std::size_t left_size = total / 2;
+        std::copy(all_keys.begin(), all_keys.begin() + left_size - 1, left->keys.begin());
+        std::copy(all_keys.begin() + left_size, all_keys.begin() + total - 1, right->keys.begin());
+        std::copy(all_counts.begin(), all_counts.begin() + left_size, left->counts.begin());
+        std::copy(all_counts.begin() + left_size, all_counts.begin() + total, right->counts.begin());
+        std::copy(all_children.begin(), all_children.begin() + left_size, left->children.begin());
+        std::copy(all_children.begin() + left_size, all_children.begin() + total, right->children.begin());
+        left->size = left_size;
+        right->size = total - left_size;
+        separator = all_keys[left_size - 1];
+        return false;
+    }
+
+    /**
+     * Copies the subtree, linking its leaves after previous_leaf.
+     */
+    static Node *copy_subtree(const Node *node, LeafNode *&previous_leaf) {
+        if (!node)
+            return nullptr;
+        if (node->is_leaf) {
+            const auto copy = new LeafNode(*static_cast<const LeafNode *>(node));
+            copy->next = nullptr;
+            if (previous_leaf)
+                previous_leaf->next = copy;
+            previous_leaf = copy;
+            return copy;
+        }
+        const auto copy = new InnerNode(*static_cast<const InnerNode *>(node));
+        for (std::size_t i = 0; i < copy->size; i++)
+            copy->children[i] = copy_subtree(copy->children[i], previous_leaf);
+        return copy;
+    }
+
+    static void destroy_subtree(Node *node) {
+        if (!node)
+            return;
+        if (node->is_leaf) {
+            delete static_cast<LeafNode *>(node);
+            return;
+        }
+        const auto inner = static_cast<InnerNode *>(node);
+        for (std::size_t i = 0; i < inner->size; i++)
+            destroy_subtree(inner->children[i]);
+        delete inner;
+    }
+};
+
+#endif //ORDER_STATISTIC_TREE_BPLUSORDERSTATISTICTREE_H
@@ -0,0 +1,241 @@
+#ifndef ORDER_STATISTIC_TREE_COMPACTORDERSTATISTICTREE_H
+#define ORDER_STATISTIC_TREE_COMPACTORDERSTATISTICTREE_H
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * Red-black order statistic tree stored in a contiguous vector.
+ *
+ * Links are 32-bit indices into the vector, the color is packed into the highest bit
+ * of the subtree count and there is no parent link, so a node takes 16 bytes.
+ * Index 0 is a black sentinel with zero count, it stands for every missing child.
+ * The tree holds at most 2^31 - 1 keys.
+ */
+class CompactOrderStatisticTree {
+protected:
+    using Index = std::uint32_t;
+
+    struct Node {
+        int key = 0;
+        Index left = NIL;
+        Index right = NIL;
+        std::uint32_t count_and_color = 0;
+    };
+
+    static constexpr Index NIL = 0;
+    static constexpr std::uint32_t RED_BIT = 1u << 31;
+    static constexpr std::size_t MAX_SIZE = RED_BIT - 1;
+    /** Red-black tree height is below 2 * log2(MAX_SIZE + 1). */
+    static constexpr std::size_t MAX_HEIGHT = 64;
+
+    std::vector<Node> nodes{Node()};
+    Index root = NIL;
+
+public:
+    CompactOrderStatisticTree() = default;
+
+    bool insert(int key) {
+        std::array<Index, MAX_HEIGHT> path;
+        std::size_t depth = 0;
+        Index cur = root;
+        while (cur != NIL) {
+            const auto &node = nodes[cur];
+            if (key == node.key)
+                return false;
+            path[depth++] = cur;
+            cur = key < node.key ? node.left : node.right;
+        }
+        if (size() == MAX_SIZE)
+            throw std::length_error("Compact tree can't hold more keys!");
+
+        const auto added = static_cast<Index>(nodes.size());
+        nodes.push_back(Node{key, NIL, NIL, 1 | RED_BIT});
+        if (depth == 0) {
+            root = added;
+        } else {
+            auto &parent = nodes[path[depth - 1]];
+            if (key < parent.key)
+                parent.left = added;
+            else
+                parent.right = added;
+        }
+        for (std::size_t i = 0; i < depth; i++)
+            nodes[path[i]].count_and_color++;
+        path[depth] = added;
+        insert_fixup(path, depth);
+        return true;
+    }
+
+    [[nodiscard]] bool contains(int key) const {
+        Index cur = root;
+        while (cur != NIL) {
+            const auto &node = nodes[cur];
+            if (key == node.key)
+                return true;
+            cur = key < node.key ? node.left : node.right;
+        }
+        return false;
+    }
+
+    [[nodiscard]] bool empty() const {
+        return root == NIL;
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return nodes.size() - 1;
+    }
+
+    void reserve(std::size_t capacity) {
+        nodes.reserve(capacity + 1);
+    }
+
+    void clear() {
+        nodes.resize(1);
+        root = NIL;
+    }
+
+    /**
+     * Bytes held by the node storage, including the unused vector capacity.
+     */
+    [[nodiscard]] std::size_t memory_usage() const {
+        return nodes.capacity() * sizeof(Node);
+    }
+
+    [[nodiscard]] int find_order_statistic(std::size_t k) const {
+        if (k == 0 || k > size())
+            throw std::logic_error("k must be from 1 to tree size!");
+        Index cur = root;
+        while (true) {
+            const auto &node = nodes[cur];
+            const std::size_t left_size = count(node.left);
+            if (k == left_size + 1)
+                return node.key;
+            if (k <= left_size) {
+                cur = node.left;
+            } else {
+                k -= left_size + 1;
+                cur = node.right;
+            }
+        }
+    }
+
+    [[nodiscard]] std::size_t less_count(int key) const {
+        std::size_t lower_count = 0;
+        Index cur = root;
+        while (cur != NIL) {
+            const auto &node = nodes[cur];
+            if (node.key < key) {
+                lower_count += count(node.left) + 1;
+                cur = node.right;
+            } else {
+                cur = node.left;
+            }
+        }
+        return lower_count;
+    }
+
+private:
+    [[nodiscard]] std::size_t count(Index index) const {
+        return nodes[index].count_and_color & ~RED_BIT;
+    }
+
+    [[nodiscard]] bool is_red(Index index) const {
+        return nodes[index].count_and_color & RED_BIT;
+    }
+
+    void set_red(Index index) {
+        nodes[index].count_and_color |= RED_BIT;
+    }
+
+    void set_black(Index index) {
+        nodes[index].count_and_color &= ~RED_BIT;
+    }
+
+    void update_count(Index index) {
+        auto &node = nodes[index];
+        const auto new_count = static_cast<std::uint32_t>(count(node.left) + count(node.right) + 1);
+        node.count_and_color = (node.count_and_color & RED_BIT) | new_count;
+    }
+
+    /**
+     * Rotations return the new top of the subtree, the caller relinks it to the parent.
+     */
+    Index left_rotate(Index index) {
+        const Index y = nodes[index].right;
+        nodes[index].right = nodes[y].left;
+        nodes[y].left = index;
+        update_count(index);
+        update_count(y);
+        return y;
+    }
+
+    Index right_rotate(Index index) {
+        const Index y = nodes[index].left;
+        nodes[index].left = nodes[y].right;
+        nodes[y].right = index;
+        update_count(index);
+        update_count(y);
+        return y;
+    }
+
+    void replace_child(Index parent, Index old_child, Index new_child) {
+        if (parent == NIL)
+            root = new_child;
+        else if (nodes[parent].left == old_child)
+            nodes[parent].left = new_child;
+        else
+            nodes[parent].right = new_child;
+    }
+
+    /**
+     * path[0..depth] is the way from the root to the added node.
+     */
+    void insert_fixup(std::array<Index, MAX_HEIGHT> &path, std::size_t depth) {
+        while (depth >= 2 && is_red(path[depth - 1])) {
+            Index cur = path[depth];
+            Index parent = path[depth - 1];
+            const Index grandpa = path[depth - 2];
+            const Index great_grandpa = depth >= 3 ? path[depth - 3] : NIL;
+            if (parent == nodes[grandpa].left) {
+                const Index uncle = nodes[grandpa].right;
+                if (is_red(uncle)) {
+                    set_black(uncle);
+                    set_black(parent);
+                    set_red(grandpa);
+                    depth -= 2;
+                    continue;
+                }
+                if (cur == nodes[parent].right) {
+                    nodes[grandpa].left = left_rotate(parent);
+                    parent = cur;
+                }
+                set_black(parent);
+                set_red(grandpa);
+                replace_child(great_grandpa, grandpa, right_rotate(grandpa));
+            } else {
+                const Index uncle = nodes[grandpa].left;
+                if (is_red(uncle)) {
+                    set_black(uncle);
+                    set_black(parent);
+                    set_red(grandpa);
+                    depth -= 2;
+                    continue;
+                }
+                if (cur == nodes[parent].left) {
+                    nodes[grandpa].right = right_rotate(parent);
+                    parent = cur;
+                }
+                set_black(parent);
+                set_red(grandpa);
+                replace_child(great_grandpa, grandpa, left_rotate(grandpa));
+            }
+            break;
+        }
+        set_black(root);
+    }
+};
+
+#endif //ORDER_STATISTIC_TREE_COMPACTORDERSTATISTICTREE_H
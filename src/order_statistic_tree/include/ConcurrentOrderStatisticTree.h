@@ -0,0 +1,169 @@
+#ifndef ORDER_STATISTIC_TREE_CONCURRENTORDERSTATISTICTREE_H
+#define ORDER_STATISTIC_TREE_CONCURRENTORDERSTATISTICTREE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <ranges>
+#include <thread>
+
+#include "OrderStatisticTree.h"
+
+/**
+ * Order statistic tree for many reading threads and serialized writers (the Left-Right technique).
+ *
+ * There are two copies of the tree. Readers work on the copy published by read_index
+ * and announce themselves in a read indicator, they never wait and never take a lock.
+ * A writer takes the mutex, changes the hidden copy, publishes it, waits until
+ * the readers of the old copy leave and repeats the change on the old copy.
+ * Every write is done twice and the memory is doubled, a batch pays for one wait.
+ */
+template<class Tree = OrderStatisticTree>
+class ConcurrentOrderStatisticTree {
+public:
+    ConcurrentOrderStatisticTree() = default;
+
+    ConcurrentOrderStatisticTree(const ConcurrentOrderStatisticTree &) = delete;
+
+    ConcurrentOrderStatisticTree &operator=(const ConcurrentOrderStatisticTree &) = delete;
+
+    /**
+     * Calls function with the current copy of the tree. The copy doesn't change during the call,
+     * so several queries in one function see the same state.
+     */
+    template<class Function>
+    auto read(Function function) const {
+        const auto version = version_index.load();
+        ReadGuard guard(read_indicators[version]);
+        return function(static_cast<const Tree &>(instances[read_index.load()]));
+    }
+
+    [[nodiscard]] bool contains(int key) const {
+        return read([key](const Tree &tree) { return tree.contains(key); });
+    }
+
+    [[nodiscard]] std::size_t less_count(int key) const {
+        return read([key](const Tree &tree) { return tree.less_count(key); });
+    }
+
+    [[nodiscard]] int find_order_statistic(std::size_t k) const {
+        return read([k](const Tree &tree) { return tree.find_order_statistic(k); });
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return read([](const Tree &tree) { return tree.size(); });
+    }
+
+    bool insert(int key) {
+        return write([key](Tree &tree) { return tree.insert(key).second; });
+    }
+
+    std::size_t erase(int key) {
+        return write([key](Tree &tree) { return tree.erase(key); });
+    }
+
+    /**
+     * Inserts the keys with one publication, returns the number of added keys.
+     */
+    template<std::ranges::input_range Range>
+    std::size_t insert_batch(const Range &keys) {
+        return write([&keys](Tree &tree) { return tree.bulk_insert(keys); });
+    }
+
+    /**
+     * Applies function to both copies: to the hidden one, then, after the publication,
+     * to the one the readers have left. The function must be deterministic.
+     * Returns the result of the first application.
+     */
+    template<class Function>
+    auto write(Function function) {
+        std::lock_guard lock(writer_mutex);
+        const auto hidden = 1 - read_index.load(std::memory_order_relaxed);
+        auto result = function(instances[hidden]);
+        read_index.store(hidden);
+        wait_for_readers();
+        function(instances[1 - hidden]);
+        return result;
+    }
+
+private:
+    static constexpr std::size_t STRIPE_COUNT = 64;
+
+    /**
+     * Number of readers inside a copy, striped over cache lines, so the readers
+     * of different threads don't write to the same line.
+     */
+    class ReadIndicator {
+    public:
+        void arrive() {
+            stripes[stripe()].readers.fetch_add(1);
+        }
+
+        void depart() {
+            stripes[stripe()].readers.fetch_sub(1);
+        }
+
+        [[nodiscard]] bool empty() const {
+            for (const auto &slot: stripes) {
+                if (slot.readers.load() != 0)
+                    return false;
+            }
+            return true;
+        }
+
+    private:
+        struct alignas(64) Stripe {
+            std::atomic<std::ptrdiff_t> readers = 0;
+        };
+
+        std::array<Stripe, STRIPE_COUNT> stripes;
+
+        static std::size_t stripe() {
+            static std::atomic<std::size_t> next_stripe = 0;
+            thread_local const std::size_t index = next_stripe.fetch_add(1) % STRIPE_COUNT;
+            return index;
+        }
+    };
+
+    class ReadGuard {
+    public:
+        explicit ReadGuard(ReadIndicator &indicator) : indicator(indicator) {
+            indicator.arrive();
+        }
+
+        ReadGuard(const ReadGuard &) = delete;
+
+        ~ReadGuard() {
+            indicator.depart();
+        }
+
+    private:
+        ReadIndicator &indicator;
+    };
+
+    std::array<Tree, 2> instances;
+    std::atomic<int> read_index = 0;
+    std::atomic<int> version_index = 0;
+    mutable std::array<ReadIndicator, 2> read_indicators;
+    std::mutex writer_mutex;
+
+    /**
+     * Readers that could have seen the old copy are registered in the current version's indicator.
+     * New readers are sent to the other indicator, then both indicators are drained one by one.
+     */
+    void wait_for_readers() {
+        const auto version = version_index.load(std::memory_order_relaxed);
+        const auto next_version = 1 - version;
+        wait_until_empty(read_indicators[next_version]);
+        version_index.store(next_version);
+        wait_until_empty(read_indicators[version]);
+    }
+
+    static void wait_until_empty(const ReadIndicator &indicator) {
+        while (!indicator.empty())
+            std::this_thread::yield();
+    }
+};
+
+#endif //ORDER_STATISTIC_TREE_CONCURRENTORDERSTATISTICTREE_H
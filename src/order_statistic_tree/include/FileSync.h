@@ -0,0 +1,25 @@
+#ifndef ORDER_STATISTIC_TREE_FILESYNC_H
+#define ORDER_STATISTIC_TREE_FILESYNC_H
+
+#include <cerrno>
+#include <fcntl.h>
+#include <filesystem>
+#include <system_error>
+#include <unistd.h>
+
+/**
+ * Flushes a file (flags O_RDONLY) or a directory (O_RDONLY | O_DIRECTORY) to the disk.
+ * Throws std::system_error on failure.
+ */
+inline void sync_path(const std::filesystem::path &path, int flags) {
+    const int fd = ::open(path.c_str(), flags | O_CLOEXEC);
+    if (fd < 0)
+        throw std::system_error(errno, std::generic_category(), "Can't open " + path.string());
+    const int result = ::fsync(fd);
+    const int error = errno;
+    ::close(fd);
+    if (result != 0)
+        throw std::system_error(error, std::generic_category(), "Can't sync " + path.string());
+}
+
+#endif //ORDER_STATISTIC_TREE_FILESYNC_H
@@ -0,0 +1,154 @@
+#ifndef ORDER_STATISTIC_TREE_FROZENORDERSTATISTICTREE_H
+#define ORDER_STATISTIC_TREE_FROZENORDERSTATISTICTREE_H
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * Immutable order statistic tree for read-only phases, made by freeze(tree).
+ *
+ * The sorted keys are stored in the Eytzinger (BFS) layout of a complete binary search tree:
+ * the children of keys[i] are keys[2i] and keys[2i + 1], so there are no pointers and no counts.
+ * less_count is a branchless descent that prefetches the 16 descendants four levels down,
+ * the in-order rank of the found node is computed from its index. find_order_statistic inverts
+ * that computation and reads one array element. 4 bytes per int key.
+ */
+template<class Key = int, class Compare = std::less<Key>>
+class FrozenOrderStatisticTree {
+public:
+    FrozenOrderStatisticTree() : keys(1) {}
+
+    /**
+     * Builds the layout from n keys in increasing order in O(n).
+     */
+    template<class Iterator>
+    FrozenOrderStatisticTree(Iterator first, std::size_t n, const Compare &compare = Compare()) :
+            keys(n + 1), compare(compare), count(n), height(static_cast<std::size_t>(std::bit_width(n))) {
+        fill(first, 1);
+        const std::size_t last_level = std::size_t{1} << (height == 0 ? 0 : height - 1);
+        missing_leaves = (std::size_t{1} << height) - 1 - n;
+        first_missing_position = 2 * (n + 1 - last_level);
+    }
+
+    template<std::ranges::input_range Range>
+    static FrozenOrderStatisticTree build_from_sorted(const Range &sorted_keys, const Compare &compare = Compare()) {
+        return FrozenOrderStatisticTree(std::ranges::begin(sorted_keys),
+                                        static_cast<std::size_t>(std::ranges::distance(sorted_keys)), compare);
+    }
+
+    [[nodiscard]] std::size_t less_count(const Key &key) const {
+        const Key *base = keys.data();
+        std::size_t node = 1;
+        while (node <= count) {
+            __builtin_prefetch(base + std::min(16 * node, count));
+            node = 2 * node + static_cast<std::size_t>(compare(base[node], key));
+        }
+        // Undo the right turns after the last left one: it was taken at the first key not less than key.
+        node >>= std::countr_one(node) + 1;
+        return node == 0 ? count : in_order_rank(node);
+    }
+
+    [[nodiscard]] bool contains(const Key &key) const {
+        const std::size_t position = less_count(key);
+        return position < count && !compare(key, keys[node_of_rank(position)]);
+    }
+
+    [[nodiscard]] Key find_order_statistic(std::size_t k) const {
+        if (k == 0 || k > count)
+            throw std::logic_error("k must be from 1 to tree size!");
+        return keys[node_of_rank(k - 1)];
+    }
+
+    void less_count_batch(std::span<const Key> queried_keys, std::span<std::size_t> counts) const {
+        if (queried_keys.size() != counts.size())
+            throw std::invalid_argument("Keys and counts must have the same size!");
+        for (std::size_t i = 0; i < queried_keys.size(); i++)
+            counts[i] = less_count(queried_keys[i]);
+    }
+
+    void find_order_statistic_batch(std::span<const std::size_t> ranks, std::span<Key> found_keys) const {
+        if (ranks.size() != found_keys.size())
+            throw std::invalid_argument("Ranks and keys must have the same size!");
+        for (std::size_t i = 0; i < ranks.size(); i++)
+            found_keys[i] = find_order_statistic(ranks[i]);
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return count;
+    }
+
+    [[nodiscard]] bool empty() const {
+        return count == 0;
+    }
+
+    [[nodiscard]] std::vector<Key> sorted_keys() const {
+        std::vector<Key> sorted;
+        sorted.reserve(count);
+        for (std::size_t rank = 0; rank < count; rank++)
+            sorted.push_back(keys[node_of_rank(rank)]);
+        return sorted;
+    }
+
+protected:
+    /** keys[0] is unused, the root is keys[1]. */
+    std::vector<Key> keys;
+    [[no_unique_address]] Compare compare;
+    std::size_t count = 0;
+    /** Number of levels, the last one may be incomplete. */
+    std::size_t height = 0;
+    /**
+     * Ranks are computed in the perfect tree of the same height, whose last-level leaves are at the even
+     * in-order positions. The absent leaves are the last ones: missing_leaves of them from first_missing_position.
+     */
+    std::size_t missing_leaves = 0;
+    std::size_t first_missing_position = 0;
+
+    template<class Iterator>
+    void fill(Iterator &first, std::size_t node) {
+        if (node > count)
+            return;
+        fill(first, 2 * node);
+        keys[node] = *first;
+        ++first;
+        fill(first, 2 * node + 1);
+    }
+
+    [[nodiscard]] std::size_t in_order_rank(std::size_t node) const {
+        const auto depth = static_cast<std::size_t>(std::bit_width(node)) - 1;
+        const std::size_t level_offset = node - (std::size_t{1} << depth);
+        const std::size_t perfect_rank = ((2 * level_offset + 1) << (height - 1 - depth)) - 1;
+        if (perfect_rank <= first_missing_position)
+            return perfect_rank;
+        const std::size_t missing_before = std::min(missing_leaves, (perfect_rank - first_missing_position + 1) / 2);
+        return perfect_rank - missing_before;
+    }
+
+    [[nodiscard]] std::size_t node_of_rank(std::size_t rank) const {
+        std::size_t perfect_rank = rank;
+        if (rank >= first_missing_position && missing_leaves > 0) {
+            const std::size_t after_first_missing = rank - first_missing_position;
+            perfect_rank = after_first_missing + 1 < missing_leaves ? first_missing_position + 2 * after_first_missing + 1
+                                                                    : rank + missing_leaves;
+        }
+        const auto levels_below = static_cast<std::size_t>(std::countr_zero(perfect_rank + 1));
+        const std::size_t depth = height - 1 - levels_below;
+        return (std::size_t{1} << depth) + ((perfect_rank + 1) >> (levels_below + 1));
+    }
+};
+
+/**
+ * Immutable copy of the keys of a tree for read-only phases, O(n).
+ */
+template<class Tree>
+FrozenOrderStatisticTree<typename Tree::key_type, typename Tree::key_compare> freeze(const Tree &tree) {
+    return FrozenOrderStatisticTree<typename Tree::key_type, typename Tree::key_compare>(tree.begin(), tree.size(),
+                                                                                         tree.key_comp());
+}
+
+#endif //ORDER_STATISTIC_TREE_FROZENORDERSTATISTICTREE_H
@@ -0,0 +1,163 @@
+#ifndef ORDER_STATISTIC_TREE_MAPPEDORDERSTATISTICTREE_H
+#define ORDER_STATISTIC_TREE_MAPPEDORDERSTATISTICTREE_H
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <functional>
+#include <span>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+#include <utility>
+
+#include "TreeSnapshot.h"
+
+/**
+ * Read-only order statistic tree over a memory-mapped snapshot (see TreeSnapshot.h).
+ *
+ * Opening maps the file and checks its header, nothing is read or built, so the startup cost
+ * doesn't depend on the number of keys and the pages are shared with the page cache.
+ * less_count descends the Eytzinger index without branches and scans one block of keys,
+ * find_order_statistic reads the sorted keys directly.
+ */
+template<class Key = int, class Compare = std::less<Key>>
+class MappedOrderStatisticTree {
+public:
+    /**
+     * Throws std::system_error if the file can't be mapped and std::runtime_error if it is not a snapshot of Key.
+     */
+    explicit MappedOrderStatisticTree(const std::filesystem::path &path, const Compare &compare = Compare()) :
+            compare(compare) {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            throw std::system_error(errno, std::generic_category(), "Can't open the snapshot " + path.string());
+        struct stat file_stat{};
+        if (::fstat(fd, &file_stat) != 0) {
+            const int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "Can't open the snapshot " + path.string());
+        }
+        mapped_size = static_cast<std::size_t>(file_stat.st_size);
+        if (mapped_size < sizeof(TreeSnapshotHeader)) {
+            ::close(fd);
+            throw std::runtime_error("The file is not a tree snapshot!");
+        }
+        void *address = ::mmap(nullptr, mapped_size, PROT_READ, MAP_SHARED, fd, 0);
+        const int error = errno;
+        ::close(fd);
+        if (address == MAP_FAILED)
+            throw std::system_error(error, std::generic_category(), "Can't map the snapshot " + path.string());
+        mapping = static_cast<const char *>(address);
+        try {
+            TreeSnapshotHeader header{};
+            std::memcpy(&header, mapping, sizeof(header));
+            const auto layout = validate_snapshot_header<Key>(header, mapped_size);
+            count = header.key_count;
+            index_size = layout.index_size;
+            keys = reinterpret_cast<const Key *>(mapping + layout.keys_offset);
+            index = reinterpret_cast<const Key *>(mapping + layout.index_offset);
+            blocks = reinterpret_cast<const std::uint32_t *>(mapping + layout.blocks_offset);
+        } catch (...) {
+            unmap();
+            throw;
+        }
+    }
+
+    MappedOrderStatisticTree(const MappedOrderStatisticTree &) = delete;
+
+    MappedOrderStatisticTree(MappedOrderStatisticTree &&other) noexcept:
+            mapping(std::exchange(other.mapping, nullptr)), mapped_size(std::exchange(other.mapped_size, 0)),
+            keys(other.keys), index(other.index), blocks(other.blocks),
+            count(std::exchange(other.count, 0)), index_size(std::exchange(other.index_size, 0)),
+            compare(other.compare) {}
+
+    MappedOrderStatisticTree &operator=(MappedOrderStatisticTree other) noexcept {
+        std::swap(mapping, other.mapping);
+        std::swap(mapped_size, other.mapped_size);
+        std::swap(keys, other.keys);
+        std::swap(index, other.index);
+        std::swap(blocks, other.blocks);
+        std::swap(count, other.count);
+        std::swap(index_size, other.index_size);
+        std::swap(compare, other.compare);
+        return *this;
+    }
+
+    ~MappedOrderStatisticTree() {
+        unmap();
+    }
+
+    [[nodiscard]] std::size_t less_count(const Key &key) const {
+        if (count == 0)
+            return 0;
+        std::size_t node = 1;
+        while (node <= index_size) {
+            // The 16 descendants four levels down are adjacent, for int keys it is one cache line.
+            if (16 * node <= index_size)
+                __builtin_prefetch(index + 16 * node - 1);
+            node = 2 * node + static_cast<std::size_t>(compare(index[node - 1], key));
+        }
+        // Undo the right turns after the last left one: it was taken at the first sample not less than key.
+        node >>= std::countr_one(node) + 1;
+        const std::size_t next_block = node == 0 ? index_size : blocks[node - 1];
+        if (next_block == 0)
+            return 0;
+        const std::size_t block_first = (next_block - 1) * SNAPSHOT_BLOCK_SIZE;
+        const std::size_t block_last = std::min(count, block_first + SNAPSHOT_BLOCK_SIZE);
+        std::size_t lower_count = block_first;
+        for (std::size_t i = block_first; i < block_last; i++)
+            lower_count += static_cast<std::size_t>(compare(keys[i], key));
+        return lower_count;
+    }
+
+    [[nodiscard]] bool contains(const Key &key) const {
+        const std::size_t position = less_count(key);
+        return position < count && !compare(key, keys[position]);
+    }
+
+    [[nodiscard]] Key find_order_statistic(std::size_t k) const {
+        if (k == 0 || k > count)
+            throw std::logic_error("k must be from 1 to tree size!");
+        return keys[k - 1];
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return count;
+    }
+
+    [[nodiscard]] bool empty() const {
+        return count == 0;
+    }
+
+    /**
+     * The mapped keys in increasing order.
+     */
+    [[nodiscard]] std::span<const Key> sorted_keys() const {
+        return {keys, count};
+    }
+
+private:
+    const char *mapping = nullptr;
+    std::size_t mapped_size = 0;
+    const Key *keys = nullptr;
+    const Key *index = nullptr;
+    const std::uint32_t *blocks = nullptr;
+    std::size_t count = 0;
+    std::size_t index_size = 0;
+    Compare compare;
+
+    void unmap() {
+        if (mapping)
+            ::munmap(const_cast<char *>(mapping), mapped_size);
+        mapping = nullptr;
+    }
+};
+
+#endif //ORDER_STATISTIC_TREE_MAPPEDORDERSTATISTICTREE_H
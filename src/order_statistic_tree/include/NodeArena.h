@@ -0,0 +1,122 @@
+#ifndef ORDER_STATISTIC_TREE_NODEARENA_H
+#define ORDER_STATISTIC_TREE_NODEARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * Allocator that carves single objects out of large contiguous slabs.
+ *
+ * Freed objects are kept in an intrusive free list and reused by the next allocation,
+ * the slabs themselves are returned to the heap only by release() or the destructor,
+ * so dropping everything costs O(number of slabs) instead of one free per object.
+ *
+ * The arena owns its memory, so copies of it are independent empty arenas
+ * and two arenas compare equal only if they are the same object.
+ */
+template<class T, std::size_t SlabSize = 4096>
+class NodeArena {
+    static_assert(SlabSize > 0, "Slab must hold at least one object!");
+
+    template<class U, std::size_t OtherSlabSize>
+    friend class NodeArena;
+
+    union Slot {
+        Slot *next;
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    template<class U>
+    struct rebind {
+        using other = NodeArena<U, SlabSize>;
+    };
+
+    NodeArena() = default;
+
+    NodeArena(const NodeArena &) noexcept: NodeArena() {}
+
+    template<class U>
+    explicit NodeArena(const NodeArena<U, SlabSize> &) noexcept: NodeArena() {}
+
+    NodeArena(NodeArena &&other) noexcept: NodeArena() {
+        swap(*this, other);
+    }
+
+    NodeArena &operator=(NodeArena other) noexcept {
+        swap(*this, other);
+        return *this;
+    }
+
+    ~NodeArena() {
+        release();
+    }
+
+    [[nodiscard]] T *allocate(std::size_t n) {
+        if (n != 1)
+            throw std::bad_array_new_length();
+        if (!free_list)
+            add_slab();
+        Slot *slot = free_list;
+        free_list = slot->next;
+        return reinterpret_cast<T *>(slot->storage);
+    }
+
+    void deallocate(T *ptr, std::size_t) noexcept {
+        auto slot = reinterpret_cast<Slot *>(ptr);
+        slot->next = free_list;
+        free_list = slot;
+    }
+
+    /**
+     * Returns all slabs to the heap. Objects living in the arena are not destroyed,
+     * so it is only safe when they are trivially destructible or already destroyed.
+     */
+    void release() noexcept {
+        for (const auto slab: slabs)
+            delete[] slab;
+        slabs.clear();
+        free_list = nullptr;
+    }
+
+    [[nodiscard]] std::size_t allocated_bytes() const {
+        return slabs.size() * SlabSize * sizeof(Slot);
+    }
+
+    friend bool operator==(const NodeArena &first, const NodeArena &second) {
+        return &first == &second;
+    }
+
+    friend void swap(NodeArena &first, NodeArena &second) noexcept {
+        using std::swap;
+        swap(first.slabs, second.slabs);
+        swap(first.free_list, second.free_list);
+    }
+
+private:
+    std::vector<Slot *> slabs;
+    Slot *free_list = nullptr;
+
+    void add_slab() {
+        // Owned here until push_back succeeds, so a failed push_back doesn't leak the slab.
+        std::unique_ptr<Slot[]> owned(new Slot[SlabSize]);
+        slabs.push_back(owned.get());
+        const auto slab = owned.release();
+        for (std::size_t i = 0; i + 1 < SlabSize; i++)
+            slab[i].next = &slab[i + 1];
+        slab[SlabSize - 1].next = free_list;
+        free_list = slab;
+    }
+};
+
+#endif //ORDER_STATISTIC_TREE_NODEARENA_H
@@ -1,10 +1,66 @@
 #ifndef ORDER_STATISTIC_TREE_H
 #define ORDER_STATISTIC_TREE_H
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <span>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
-class OrderStatisticTree {
+#include "Augmentation.h"
+
+/**
+ * Allocators that can drop all of their memory at once (e.g. NodeArena).
+ * The tree skips the node-by-node teardown for them.
+ */
+template<class Allocator>
+concept BulkReleasingAllocator = requires(Allocator allocator) {
+    allocator.release();
+};
+
+/**
+ * Red-black tree with subtree counts, ordered by Compare.
+ *
+ * Every node also keeps the Augmentation of its subtree, updated together with the counts,
+ * e.g. the sum of the keys for prefix_summary. The default NoAugmentation is empty and costs nothing.
+ *
+ * With AllowDuplicates the tree is a multiset: a node holds a distinct key with the number
+ * of its occurrences and the subtree counts sum those multiplicities, so the memory grows
+ * with the number of distinct keys while ranks still count every occurrence.
+ */
+template<
+        class Key = int,
+        class Compare = std::less<Key>,
+        class Augmentation = NoAugmentation,
+        class Allocator = std::allocator<Key>,
+        bool AllowDuplicates = false
+>
+requires TreeAugmentation<Augmentation, Key>
+class BasicOrderStatisticTree {
 protected:
+    using Summary = typename Augmentation::value_type;
+
+    static constexpr bool AUGMENTED = !std::is_empty_v<Summary>;
+
+    /** Multiplicity of a set node, it is always one and takes no space. */
+    struct UnitMultiplicity {
+        static constexpr std::size_t value = 1;
+    };
+
+    struct CountedMultiplicity {
+        std::size_t value = 1;
+    };
+
+    using Multiplicity = std::conditional_t<AllowDuplicates, CountedMultiplicity, UnitMultiplicity>;
+
     struct Node {
         enum class Color {
             RED = 0,
@@ -12,14 +68,16 @@ protected:
         };
 
         Color color = Color::RED;
-        int key = 0;
+        Key key{};
         std::size_t count = 1;
+        [[no_unique_address]] Multiplicity multiplicity;
+        [[no_unique_address]] Summary summary{};
         Node *left = nullptr;
         Node *right = nullptr;
         Node *parent = nullptr;
 
         explicit Node(
-                int key,
+                const Key &key,
                 Color color = Color::RED,
                 Node *parent = nullptr,
                 Node *left = nullptr,
@@ -27,29 +85,9 @@ protected:
         ) : key(key), color(color), parent(parent),
             left(left), right(right) {}
 
-        Node(const Node &other) : key(other.key), color(other.color), count(other.count) {
-            if (other.left) {
-                left = new Node(*other.left);
-            }
-            if (other.right) {
-                right = new Node(*other.right);
-            }
-            update_children_parent();
-        }
-
-        Node(Node &&other) noexcept: Node() {
-            swap(*this, other);
-        }
+        Node(const Node &) = delete;
 
-        Node &operator=(Node other) {
-            swap(*this, other);
-            return *this;
-        }
-
-        ~Node() {
-            delete right;
-            delete left;
-        }
+        Node &operator=(const Node &) = delete;
 
         void left_rotate(Node *&root_node) {
             if (!right)
@@ -97,6 +135,22 @@ protected:
             return right ? right->count : 0;
         }
 
+        [[nodiscard]] Summary left_summary() const {
+            return left ? left->summary : Augmentation::identity();
+        }
+
+        [[nodiscard]] Summary right_summary() const {
+            return right ? right->summary : Augmentation::identity();
+        }
+
+        void update_summary() {
+            if constexpr (AUGMENTED) {
+                summary = Augmentation::combine(
+                        Augmentation::combine(left_summary(), Augmentation::from_key(key, multiplicity.value)),
+                        right_summary());
+            }
+        }
+
         [[nodiscard]] friend bool equals(const Node *first, const Node *second) {
             if (first == nullptr ^ second == nullptr)
                 return false;
@@ -104,39 +158,25 @@ protected:
                 return true;
             return first->color == second->color &&
                    first->key == second->key &&
+                   first->multiplicity.value == second->multiplicity.value &&
                    equals(first->left, second->left) &&
                    equals(first->right, second->right);
         }
 
-        friend void swap(Node &first, Node &second) noexcept {
-            using std::swap;
-            swap(first.count, second.count);
-            swap(first.key, second.key);
-            swap(first.color, second.color);
-            swap_children(first, second);
-            swap_parents(first, second);
-        }
-
     private:
-        Node() = default;
-
-        void update_children_parent() {
-            update_left_child_parent();
-            update_right_child_parent();
-        }
-
         void update_left_child_parent() {
             if (left)
                 left->parent = this;
         }
 
         void update_count() {
-            std::size_t new_count = 1;
+            std::size_t new_count = multiplicity.value;
             if (left)
                 new_count += left->count;
             if (right)
                 new_count += right->count;
             this->count = new_count;
+            update_summary();
         }
 
         void update_right_child_parent() {
@@ -152,73 +192,427 @@ protected:
             else
                 parent->right = new_child;
         }
+    };
 
-        friend void swap_children(Node &first, Node &second) {
-            std::swap(first.left, second.left);
-            std::swap(first.right, second.right);
-            first.update_children_parent();
-            second.update_children_parent();
-        }
-
-        friend void swap_parents(Node &first, Node &second) {
-            first.set_parent_child_to(&second);
-            second.set_parent_child_to(&first);
-            std::swap(first.parent, second.parent);
-        }
+    /** Distinct key with the number of its occurrences. */
+    struct KeyRun {
+        Key key;
+        std::size_t multiplicity;
     };
 
+    using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using NodeAllocatorTraits = std::allocator_traits<NodeAllocator>;
+
+    /** Number of queries of a batch that walk the tree together. */
+    static constexpr std::size_t BATCH_LANES = 16;
+
+    /** Interleaving doesn't pay off while the tree is in the cache. */
+    static constexpr std::size_t BATCH_MIN_TREE_SIZE = 1 << 17;
+
+    /** Nodes of one tree can be linked into another one only if their allocators are interchangeable. */
+    static constexpr bool NODES_ARE_MOVABLE = NodeAllocatorTraits::is_always_equal::value;
+
+    /** Smaller halves of a union are united in the calling thread. */
+    static constexpr std::size_t PARALLEL_UNION_CUTOFF = 1 << 14;
+
     Node *root = nullptr;
     std::size_t count = 0;
+    NodeAllocator allocator;
+    [[no_unique_address]] Compare compare;
 
 public:
-    OrderStatisticTree() = default;
+    /**
+     * Bidirectional iterator over the keys in increasing order, a multiset key is visited
+     * once per occurrence. Keys are immutable.
+     * Decrementing end() needs the tree the iterator was taken from.
+     */
+    class iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = Key;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Key *;
+        using reference = const Key &;
 
-    OrderStatisticTree(const OrderStatisticTree &other) :
-            root(new Node(*other.root)), count(other.count) {}
+        iterator() = default;
+
+        reference operator*() const {
+            return node->key;
+        }
+
+        pointer operator->() const {
+            return &node->key;
+        }
 
-    OrderStatisticTree(OrderStatisticTree &&other) noexcept: OrderStatisticTree() {
+        iterator &operator++() {
+            if (occurrence + 1 < node->multiplicity.value) {
+                occurrence++;
+            } else {
+                node = successor(node);
+                occurrence = 0;
+            }
+            return *this;
+        }
+
+        iterator operator++(int) {
+            auto old = *this;
+            ++*this;
+            return old;
+        }
+
+        iterator &operator--() {
+            if (occurrence > 0) {
+                occurrence--;
+            } else {
+                node = node ? predecessor(node) : rightmost(tree->root);
+                occurrence = node->multiplicity.value - 1;
+            }
+            return *this;
+        }
+
+        iterator operator--(int) {
+            auto old = *this;
+            --*this;
+            return old;
+        }
+
+        bool operator==(const iterator &other) const {
+            return node == other.node && occurrence == other.occurrence;
+        }
+
+    private:
+        friend class BasicOrderStatisticTree;
+
+        const Node *node = nullptr;
+        const BasicOrderStatisticTree *tree = nullptr;
+        /** Index of the occurrence of the multiset key, always 0 for a set. */
+        std::size_t occurrence = 0;
+
+        iterator(const Node *node, const BasicOrderStatisticTree *tree, std::size_t occurrence = 0) :
+                node(node), tree(tree), occurrence(occurrence) {}
+    };
+
+    using const_iterator = iterator;
+    using key_type = Key;
+    using key_compare = Compare;
+
+    BasicOrderStatisticTree() = default;
+
+    explicit BasicOrderStatisticTree(const Compare &compare) : compare(compare) {}
+
+    BasicOrderStatisticTree(const BasicOrderStatisticTree &other) :
+            count(other.count),
+            allocator(NodeAllocatorTraits::select_on_container_copy_construction(other.allocator)),
+            compare(other.compare) {
+        root = copy_subtree(other.root, nullptr);
+    }
+
+    BasicOrderStatisticTree(BasicOrderStatisticTree &&other) noexcept: BasicOrderStatisticTree() {
         swap(*this, other);
     }
 
-    OrderStatisticTree &operator=(OrderStatisticTree tree) {
+    BasicOrderStatisticTree &operator=(BasicOrderStatisticTree tree) {
         swap(*this, tree);
         return *this;
     }
 
-    ~OrderStatisticTree() {
-        delete root;
+    ~BasicOrderStatisticTree() {
+        clear();
     }
 
-    bool insert(int key) {
-        if (contains(key))
-            return false;
+    void clear() {
+        if constexpr (BulkReleasingAllocator<NodeAllocator> && std::is_trivially_destructible_v<Node>)
+            allocator.release();
+        else
+            destroy_subtree(root);
+        root = nullptr;
+        count = 0;
+    }
+
+    /**
+     * Builds a perfectly balanced tree from strictly increasing keys in O(n).
+     * A multiset accepts non-decreasing keys.
+     */
+    template<std::ranges::random_access_range Range>
+    static BasicOrderStatisticTree build_from_sorted(const Range &keys, const Compare &compare = Compare()) {
+        const auto first = std::ranges::begin(keys);
+        const auto n = static_cast<std::size_t>(std::ranges::size(keys));
+        BasicOrderStatisticTree tree(compare);
+        if constexpr (AllowDuplicates) {
+            if (!std::is_sorted(first, first + n, compare))
+                throw std::invalid_argument("Keys must be sorted!");
+            std::vector<KeyRun> runs;
+            for (std::size_t i = 0; i < n; i++)
+                tree.append_run(runs, first[i], 1);
+            tree.build(runs.begin(), runs.size());
+        } else {
+            const auto not_increasing = [&compare](const Key &previous, const Key &next) {
+                return !compare(previous, next);
+            };
+            if (std::adjacent_find(first, first + n, not_increasing) != first + n)
+                throw std::invalid_argument("Keys must be sorted and unique!");
+            tree.build(first, n);
+        }
+        return tree;
+    }
+
+    /**
+     * Inserts keys in any order with duplicates. Large batches are sorted, deduplicated and merged
+     * with the tree keys, then the tree is rebuilt in O(n + m log m). Returns the number of added keys.
+     * A multiset keeps the duplicates, only equal keys are merged into one node.
+     */
+    template<std::ranges::input_range Range>
+    std::size_t bulk_insert(const Range &keys) {
+        std::vector<Key> added(std::ranges::begin(keys), std::ranges::end(keys));
+        std::sort(added.begin(), added.end(), compare);
+        if constexpr (!AllowDuplicates) {
+            const auto equivalent = [this](const Key &previous, const Key &next) {
+                return !compare(previous, next) && !compare(next, previous);
+            };
+            added.erase(std::unique(added.begin(), added.end(), equivalent), added.end());
+        }
+
+        const std::size_t old_size = size();
+        if (added.size() * std::bit_width(old_size) < old_size) {
+            for (const auto key: added)
+                insert(key);
+            return size() - old_size;
+        }
 
-        Node *new_node = new Node(key);
-        const auto parent = find_position_to_add(key);
+        if constexpr (AllowDuplicates) {
+            std::vector<KeyRun> merged;
+            const Node *node = leftmost(root);
+            auto key = added.begin();
+            while (node || key != added.end()) {
+                if (key == added.end() || (node && compare(node->key, *key))) {
+                    append_run(merged, node->key, node->multiplicity.value);
+                    node = successor(node);
+                } else {
+                    append_run(merged, *key, 1);
+                    ++key;
+                }
+            }
+            BasicOrderStatisticTree tree(compare);
+            tree.build(merged.begin(), merged.size());
+            *this = std::move(tree);
+        } else {
+            std::vector<Key> merged;
+            merged.reserve(old_size + added.size());
+            const auto old_keys = sorted_keys();
+            std::set_union(old_keys.begin(), old_keys.end(), added.begin(), added.end(),
+                           std::back_inserter(merged), compare);
+            BasicOrderStatisticTree tree(compare);
+            tree.build(merged.begin(), merged.size());
+            *this = std::move(tree);
+        }
+        return size() - old_size;
+    }
+
+    /**
+     * Joins two trees and a key between them: the keys of left must be less than key
+     * and key less than the keys of right. The smaller tree is hung on the spine of the bigger one
+     * at the same black height, O(difference of the heights).
+     * If the allocator is not always equal (e.g. NodeArena), nodes can't move between trees and both trees
+     * are copied into a new one instead, O(n + m).
+     */
+    static BasicOrderStatisticTree join(BasicOrderStatisticTree left, const Key &key, BasicOrderStatisticTree right) {
+        if ((left.root && !left.compare(rightmost(left.root)->key, key)) ||
+            (right.root && !left.compare(key, leftmost(right.root)->key)))
+            throw std::invalid_argument("Keys of the left tree must be less than the key "
+                                        "and the key less than keys of the right tree!");
+        if constexpr (!NODES_ARE_MOVABLE) {
+            left.insert(key);
+            return merge_and_build(left, right);
+        } else {
+            Node *middle = left.create_node(key);
+            left.set_root(left.join_subtrees(left.release_subtree(), middle, right.release_subtree()));
+            return left;
+        }
+    }
+
+    /**
+     * Joins two trees, the keys of left must be less than the keys of right. O(log n).
+     * With an allocator that is not always equal both trees are copied into a new one, O(n + m).
+     */
+    static BasicOrderStatisticTree join(BasicOrderStatisticTree left, BasicOrderStatisticTree right) {
+        if (left.root && right.root && !left.compare(rightmost(left.root)->key, leftmost(right.root)->key))
+            throw std::invalid_argument("Keys of the left tree must be less than keys of the right tree!");
+        if constexpr (!NODES_ARE_MOVABLE) {
+            return merge_and_build(left, right);
+        } else {
+            if (!left.root)
+                return right;
+            Node *last;
+            const auto rest = left.split_last(left.release_subtree(), last);
+            left.set_root(left.join_subtrees(rest, last, right.release_subtree()));
+            return left;
+        }
+    }
+
+    /**
+     * Leaves the keys less than key in this tree and returns the tree of the other keys. O(log n).
+     * With an allocator that is not always equal both parts are rebuilt from the keys, O(n).
+     */
+    BasicOrderStatisticTree split(const Key &key) {
+        BasicOrderStatisticTree greater(compare);
+        if constexpr (!NODES_ARE_MOVABLE) {
+            auto runs = key_runs();
+            const auto bound = std::partition_point(runs.begin(), runs.end(), [this, &key](const KeyRun &run) {
+                return compare(run.key, key);
+            });
+            BasicOrderStatisticTree less(compare);
+            less.build_runs(runs.begin(), bound);
+            greater.build_runs(bound, runs.end());
+            *this = std::move(less);
+        } else {
+            const auto [less_part, greater_part] = split_subtree(release_subtree(), key);
+            set_root(less_part);
+            greater.set_root(greater_part);
+        }
+        return greater;
+    }
+
+    /**
+     * Moves all keys of other into this tree, a multiset adds up the occurrences.
+     * The union recursively splits other by the root key of this tree and joins the united halves,
+     * O(m log(n / m + 1)) for trees of sizes m <= n. Halves of at least PARALLEL_UNION_CUTOFF keys
+     * are united by up to max_threads threads. With an allocator that is not always equal
+     * the sorted keys of both trees are merged into a new tree instead, O(n + m) in one thread.
+     */
+    void unite(BasicOrderStatisticTree other, std::size_t max_threads = 1) {
+        if constexpr (!NODES_ARE_MOVABLE) {
+            *this = merge_and_build(*this, other);
+        } else {
+            const auto fork_depth = static_cast<std::size_t>(std::bit_width(std::max<std::size_t>(max_threads, 1)) - 1);
+            set_root(unite_subtrees(release_subtree(), other.release_subtree(), fork_depth));
+        }
+    }
+
+    /**
+     * Keys in increasing order, a multiset key is repeated for every occurrence.
+     */
+    [[nodiscard]] std::vector<Key> sorted_keys() const {
+        return std::vector<Key>(begin(), end());
+    }
+
+    [[nodiscard]] Compare key_comp() const {
+        return compare;
+    }
+
+    [[nodiscard]] iterator begin() const {
+        return iterator(leftmost(root), this);
+    }
+
+    [[nodiscard]] iterator end() const {
+        return iterator(nullptr, this);
+    }
+
+    [[nodiscard]] iterator find(const Key &key) const {
+        return iterator(find_node(key), this);
+    }
+
+    /**
+     * Finds the place of the key and increments the counts on the way down in one descent.
+     * If the key already exists, the increments are rolled back and the existing key is returned.
+     * A multiset keeps the increments and adds an occurrence to the existing node instead.
+     */
+    std::pair<iterator, bool> insert(const Key &key) {
+        Node *parent = nullptr;
+        Node *cur = root;
+        while (cur) {
+            const bool less = compare(key, cur->key);
+            if (!less && !compare(cur->key, key)) {
+                if constexpr (AllowDuplicates) {
+                    cur->multiplicity.value++;
+                    cur->count++;
+                    count++;
+                    update_summaries_from_bottom_to_top(cur);
+                    return {iterator(cur, this, cur->multiplicity.value - 1), true};
+                } else {
+                    decrement_from_bottom_to_top(cur, 1);
+                    return {iterator(cur, this), false};
+                }
+            }
+            cur->count++;
+            parent = cur;
+            cur = less ? cur->left : cur->right;
+        }
+
+        Node *new_node = create_node(key);
         new_node->parent = parent;
         if (!parent)
             root = new_node;
-        else if (new_node->key < parent->key)
+        else if (compare(key, parent->key))
             parent->left = new_node;
         else
             parent->right = new_node;
-        insert_fixup(new_node);
-        increment_from_bottom_to_top(new_node);
+        update_summaries_from_bottom_to_top(new_node);
+        insert_fixup(new_node, root);
         count++;
-        return true;
+        return {iterator(new_node, this), true};
+    }
+
+    /**
+     * Erases all occurrences of the key and returns their number: 0 or 1 for a set.
+     */
+    std::size_t erase(const Key &key) {
+        const auto position = find(key);
+        if (position == end())
+            return 0;
+        const std::size_t erased = position.node->multiplicity.value;
+        erase_node(const_cast<Node *>(position.node));
+        return erased;
     }
 
-    [[nodiscard]] bool contains(int key) const {
+    /**
+     * Erases the key at the position and returns the position of the next key.
+     * Only one occurrence of a multiset key is erased.
+     */
+    iterator erase(iterator position) {
+        const auto node = const_cast<Node *>(position.node);
+        if constexpr (AllowDuplicates) {
+            if (node->multiplicity.value > 1) {
+                node->multiplicity.value--;
+                node->count--;
+                decrement_from_bottom_to_top(node, 1);
+                count--;
+                update_summaries_from_bottom_to_top(node);
+                if (position.occurrence < node->multiplicity.value)
+                    return position;
+                return iterator(successor(node), this);
+            }
+        }
+        const auto next = iterator(successor(node), this);
+        erase_node(node);
+        return next;
+    }
+
+    /**
+     * Erases the k-th smallest key and returns it.
+     */
+    Key erase_kth(std::size_t k) {
+        if (k == 0 || k > size())
+            throw std::logic_error("k must be from 1 to tree size!");
         Node *cur = root;
-        while (cur) {
-            if (cur->key == key)
-                return true;
-            else if (key < cur->key)
+        while (true) {
+            const std::size_t left_size = cur->left_count();
+            if (k <= left_size) {
                 cur = cur->left;
-            else
+            } else if (k <= left_size + cur->multiplicity.value) {
+                k -= left_size + 1;
+                break;
+            } else {
+                k -= left_size + cur->multiplicity.value;
                 cur = cur->right;
+            }
         }
-        return false;
+        const Key key = cur->key;
+        erase(iterator(cur, this, k));
+        return key;
+    }
+
+    [[nodiscard]] bool contains(const Key &key) const {
+        return find_node(key) != nullptr;
     }
 
     [[nodiscard]] bool empty() const {
@@ -229,11 +623,11 @@ public:
         return !empty();
     }
 
-    bool operator==(const OrderStatisticTree &other) const {
+    bool operator==(const BasicOrderStatisticTree &other) const {
         return count == other.count && equals(root, other.root);
     }
 
-    bool operator!=(const OrderStatisticTree &other) const {
+    bool operator!=(const BasicOrderStatisticTree &other) const {
         return !operator==(other);
     }
 
@@ -241,44 +635,624 @@ public:
         return count;
     }
 
-    [[nodiscard]] int find_order_statistic(std::size_t k) const {
+    /**
+     * Single top-down pass. Both children are prefetched on every level: the count of the left one
+     * is read anyway, so loading the right one overlaps with it.
+     */
+    [[nodiscard]] Key find_order_statistic(std::size_t k) const {
+        if (k == 0 || k > size())
+            throw std::logic_error("k must be from 1 to tree size!");
+        const Node *cur = root;
+        while (true) {
+            prefetch_children(cur);
+            const std::size_t left_size = cur->left_count();
+            if (k <= left_size) {
+                cur = cur->left;
+            } else if (k <= left_size + cur->multiplicity.value) {
+                return cur->key;
+            } else {
+                k -= left_size + cur->multiplicity.value;
+                cur = cur->right;
+            }
+        }
+    }
+
+    /**
+     * Augmentation of the k smallest keys, e.g. their sum with SumAugmentation.
+     */
+    [[nodiscard]] Summary prefix_summary(std::size_t k) const {
         if (k > size())
             throw std::logic_error("k mustn't be more than tree size!");
-        return find_order_statistic(root, k);
+        Summary result = Augmentation::identity();
+        const Node *cur = root;
+        while (k > 0) {
+            const std::size_t left_size = cur->left_count();
+            if (k <= left_size) {
+                cur = cur->left;
+                continue;
+            }
+            result = Augmentation::combine(result, cur->left_summary());
+            k -= left_size;
+            const std::size_t taken = std::min(k, static_cast<std::size_t>(cur->multiplicity.value));
+            result = Augmentation::combine(result, Augmentation::from_key(cur->key, taken));
+            k -= taken;
+            cur = cur->right;
+        }
+        return result;
     }
 
-    [[nodiscard]] std::size_t less_count(int key) const {
-        auto cur = find_position_to_add(key);
-        if (!cur)
-            return 0;
+    /**
+     * Augmentation of all keys.
+     */
+    [[nodiscard]] Summary summary() const {
+        return root ? root->summary : Augmentation::identity();
+    }
 
+    /**
+     * Single top-down pass that adds the left subtree and the node itself on every turn to the right.
+     */
+    [[nodiscard]] std::size_t less_count(const Key &key) const {
         std::size_t lower_count = 0;
-        if (key >= cur->key) {
-            lower_count += cur->left_count();
-            if (key > cur->key)
-                lower_count++;
+        const Node *cur = root;
+        while (cur) {
+            prefetch_children(cur);
+            if (compare(cur->key, key)) {
+                lower_count += cur->left_count() + cur->multiplicity.value;
+                cur = cur->right;
+            } else {
+                cur = cur->left;
+            }
         }
+        return lower_count;
+    }
 
-        auto parent = cur->parent;
-        while (parent) {
-            if (cur == parent->right) {
-                lower_count += parent->left_count();
-                if (key > parent->key)
-                    lower_count++;
+    /**
+     * less_count for every key, counts[i] is the result for keys[i].
+     * BATCH_LANES queries walk the tree at once, one level per round: the children of the nodes
+     * are prefetched a round before they are read, so the cache misses of the lanes overlap.
+     * A tree smaller than BATCH_MIN_TREE_SIZE fits in the cache, its queries run one by one.
+     */
+    void less_count_batch(std::span<const Key> keys, std::span<std::size_t> counts) const {
+        if (keys.size() != counts.size())
+            throw std::invalid_argument("Keys and counts must have the same size!");
+        if (count < BATCH_MIN_TREE_SIZE) {
+            for (std::size_t i = 0; i < keys.size(); i++)
+                counts[i] = less_count(keys[i]);
+            return;
+        }
+        const auto start = [](std::size_t) -> std::size_t { return 0; };
+        run_batch(keys.size(), start, [&](BatchLane &lane) {
+            const Node *node = lane.node;
+            if (compare(node->key, keys[lane.query])) {
+                lane.result += node->left_count() + node->multiplicity.value;
+                lane.node = node->right;
+            } else {
+                lane.node = node->left;
             }
-            cur = parent;
-            parent = cur->parent;
+            if (!lane.node)
+                counts[lane.query] = lane.result;
+        });
+    }
+
+    /**
+     * find_order_statistic for every rank, keys[i] is the result for ranks[i].
+     * The lanes walk the tree the same way as in less_count_batch.
+     */
+    void find_order_statistic_batch(std::span<const std::size_t> ranks, std::span<Key> keys) const {
+        if (ranks.size() != keys.size())
+            throw std::invalid_argument("Ranks and keys must have the same size!");
+        for (const auto k: ranks) {
+            if (k == 0 || k > size())
+                throw std::logic_error("k must be from 1 to tree size!");
         }
-        return lower_count;
+        if (count < BATCH_MIN_TREE_SIZE) {
+            for (std::size_t i = 0; i < ranks.size(); i++)
+                keys[i] = find_order_statistic(ranks[i]);
+            return;
+        }
+        const auto start = [&ranks](std::size_t query) { return ranks[query]; };
+        run_batch(ranks.size(), start, [&](BatchLane &lane) {
+            const Node *node = lane.node;
+            const std::size_t left_size = node->left_count();
+            if (lane.result <= left_size) {
+                lane.node = node->left;
+            } else if (lane.result <= left_size + node->multiplicity.value) {
+                keys[lane.query] = node->key;
+                lane.node = nullptr;
+            } else {
+                lane.result -= left_size + node->multiplicity.value;
+                lane.node = node->right;
+            }
+        });
     }
 
-    friend void swap(OrderStatisticTree &first, OrderStatisticTree &second) {
-        std::swap(first.root, second.root);
-        std::swap(first.count, second.count);
+    friend void swap(BasicOrderStatisticTree &first, BasicOrderStatisticTree &second) noexcept {
+        using std::swap;
+        swap(first.root, second.root);
+        swap(first.count, second.count);
+        swap(first.allocator, second.allocator);
+        swap(first.compare, second.compare);
     }
 
 private:
-    void insert_fixup(Node *added) {
+    Node *create_node(const Key &key) {
+        Node *node = NodeAllocatorTraits::allocate(allocator, 1);
+        NodeAllocatorTraits::construct(allocator, node, key);
+        return node;
+    }
+
+    void destroy_node(Node *node) {
+        NodeAllocatorTraits::destroy(allocator, node);
+        NodeAllocatorTraits::deallocate(allocator, node, 1);
+    }
+
+    /**
+     * Post-order teardown through parent links, so it doesn't depend on the tree height.
+     */
+    void destroy_subtree(Node *node) {
+        while (node) {
+            if (node->left) {
+                node = node->left;
+            } else if (node->right) {
+                node = node->right;
+            } else {
+                const auto parent = node->parent;
+                if (parent && parent->left == node)
+                    parent->left = nullptr;
+                else if (parent)
+                    parent->right = nullptr;
+                destroy_node(node);
+                node = parent;
+            }
+        }
+    }
+
+    static Node *leftmost(Node *node) {
+        if (node) {
+            while (node->left)
+                node = node->left;
+        }
+        return node;
+    }
+
+    static Node *rightmost(Node *node) {
+        if (node) {
+            while (node->right)
+                node = node->right;
+        }
+        return node;
+    }
+
+    static Node *predecessor(const Node *node) {
+        if (node->left)
+            return rightmost(node->left);
+        while (node->parent && node == node->parent->left)
+            node = node->parent;
+        return node->parent;
+    }
+
+    static Node *successor(const Node *node) {
+        if (node->right)
+            return leftmost(node->right);
+        while (node->parent && node == node->parent->right)
+            node = node->parent;
+        return node->parent;
+    }
+
+    [[nodiscard]] Node *find_node(const Key &key) const {
+        Node *cur = root;
+        while (cur) {
+            if (compare(key, cur->key))
+                cur = cur->left;
+            else if (compare(cur->key, key))
+                cur = cur->right;
+            else
+                break;
+        }
+        return cur;
+    }
+
+    void append_run(std::vector<KeyRun> &runs, const Key &key, std::size_t multiplicity) const {
+        if (!runs.empty() && !compare(runs.back().key, key))
+            runs.back().multiplicity += multiplicity;
+        else
+            runs.push_back(KeyRun{key, multiplicity});
+    }
+
+    /**
+     * Builds the empty tree from n distinct increasing keys or key runs.
+     */
+    template<class Iterator>
+    void build(Iterator first, std::size_t n) {
+        const auto red_depth = static_cast<std::size_t>(std::bit_width(n + 1) - 1);
+        root = build_subtree(first, n, 0, red_depth, nullptr);
+        count = root ? root->count : 0;
+    }
+
+    /**
+     * Nodes are created in pre-order. Only the nodes of the last, incomplete level are red,
+     * so every path has the same number of black nodes.
+     */
+    template<class Iterator>
+    Node *build_subtree(Iterator first, std::size_t n, std::size_t depth, std::size_t red_depth, Node *parent) {
+        if (n == 0)
+            return nullptr;
+        const std::size_t left_size = (n - 1) / 2;
+        Node *node;
+        if constexpr (std::is_same_v<std::iter_value_t<Iterator>, KeyRun>) {
+            node = create_node(first[left_size].key);
+            node->multiplicity.value = first[left_size].multiplicity;
+        } else {
+            node = create_node(first[left_size]);
+        }
+        node->color = depth == red_depth ? Node::Color::RED : Node::Color::BLACK;
+        node->parent = parent;
+        node->left = build_subtree(first, left_size, depth + 1, red_depth, node);
+        node->right = build_subtree(first + left_size + 1, n - left_size - 1, depth + 1, red_depth, node);
+        node->count = node->left_count() + node->right_count() + node->multiplicity.value;
+        node->update_summary();
+        return node;
+    }
+
+    Node *copy_subtree(const Node *node, Node *parent) {
+        if (!node)
+            return nullptr;
+        Node *copy = create_node(node->key);
+        copy->color = node->color;
+        copy->count = node->count;
+        copy->multiplicity = node->multiplicity;
+        copy->summary = node->summary;
+        copy->parent = parent;
+        copy->left = copy_subtree(node->left, copy);
+        copy->right = copy_subtree(node->right, copy);
+        return copy;
+    }
+
+    /**
+     * Keys with their multiplicities in increasing order.
+     */
+    [[nodiscard]] std::vector<KeyRun> key_runs() const {
+        std::vector<KeyRun> runs;
+        runs.reserve(count);
+        for (const Node *node = leftmost(root); node; node = successor(node))
+            runs.push_back(KeyRun{node->key, node->multiplicity.value});
+        return runs;
+    }
+
+    /**
+     * Builds the empty tree from increasing key runs.
+     */
+    template<class Iterator>
+    void build_runs(Iterator first, Iterator last) {
+        const auto n = static_cast<std::size_t>(last - first);
+        if constexpr (AllowDuplicates) {
+            build(first, n);
+        } else {
+            std::vector<Key> keys;
+            keys.reserve(n);
+            for (auto run = first; run != last; ++run)
+                keys.push_back(run->key);
+            build(keys.begin(), n);
+        }
+    }
+
+    /**
+     * Union of the keys of both trees built from scratch, for the allocators
+     * whose nodes can't be moved between trees.
+     */
+    static BasicOrderStatisticTree merge_and_build(const BasicOrderStatisticTree &first,
+                                                   const BasicOrderStatisticTree &second) {
+        const auto first_runs = first.key_runs();
+        const auto second_runs = second.key_runs();
+        std::vector<KeyRun> merged;
+        merged.reserve(first_runs.size() + second_runs.size());
+        auto run = first_runs.begin();
+        auto other_run = second_runs.begin();
+        while (run != first_runs.end() || other_run != second_runs.end()) {
+            if (other_run == second_runs.end() ||
+                (run != first_runs.end() && !first.compare(other_run->key, run->key))) {
+                first.append_run(merged, run->key, run->multiplicity);
+                ++run;
+            } else {
+                first.append_run(merged, other_run->key, other_run->multiplicity);
+                ++other_run;
+            }
+        }
+        BasicOrderStatisticTree tree(first.compare);
+        tree.build_runs(merged.begin(), merged.end());
+        return tree;
+    }
+
+    /** Detached subtree with its black height: the number of black nodes on a path from its root to null. */
+    struct Subtree {
+        Node *root = nullptr;
+        std::size_t black_height = 0;
+    };
+
+    /**
+     * Takes the nodes out of the tree, it becomes empty.
+     */
+    Subtree release_subtree() {
+        Subtree subtree{root, 0};
+        for (const Node *node = root; node; node = node->left) {
+            if (is_black(node))
+                subtree.black_height++;
+        }
+        root = nullptr;
+        count = 0;
+        return subtree;
+    }
+
+    void set_root(const Subtree &subtree) {
+        root = subtree.root;
+        count = root ? root->count : 0;
+    }
+
+    /**
+     * Detaches a child of the root of the subtree.
+     */
+    static Subtree child_subtree(const Subtree &subtree, Node *child) {
+        if (child)
+            child->parent = nullptr;
+        return Subtree{child, subtree.black_height - (is_black(subtree.root) ? 1 : 0)};
+    }
+
+    /**
+     * Links the keys of left, middle and the keys of right into one subtree. The roots are painted black,
+     * middle replaces the first black node of the same black height on the inner spine of the higher subtree
+     * and takes it and the lower subtree as its children, then a red middle is fixed as after an insertion.
+     */
+    Subtree join_subtrees(Subtree left, Node *middle, Subtree right) {
+        using Color = Node::Color;
+
+        for (auto subtree: {&left, &right}) {
+            if (subtree->root && subtree->root->color == Color::RED) {
+                subtree->root->color = Color::BLACK;
+                subtree->black_height++;
+            }
+        }
+        middle->color = Color::RED;
+        const bool left_is_higher = left.black_height >= right.black_height;
+        const auto &higher = left_is_higher ? left : right;
+        const auto &lower = left_is_higher ? right : left;
+
+        Node *parent = nullptr;
+        Node *cur = higher.root;
+        std::size_t height = higher.black_height;
+        while (!is_black(cur) || height != lower.black_height) {
+            if (is_black(cur))
+                height--;
+            parent = cur;
+            cur = left_is_higher ? cur->right : cur->left;
+        }
+
+        middle->left = left_is_higher ? cur : lower.root;
+        middle->right = left_is_higher ? lower.root : cur;
+        middle->parent = parent;
+        for (const auto child: {middle->left, middle->right}) {
+            if (child)
+                child->parent = middle;
+        }
+        middle->count = middle->left_count() + middle->right_count() + middle->multiplicity.value;
+        Node *subtree_root = middle;
+        if (parent) {
+            (left_is_higher ? parent->right : parent->left) = middle;
+            const std::size_t added = middle->count - (cur ? cur->count : 0);
+            for (Node *ancestor = parent; ancestor; ancestor = ancestor->parent)
+                ancestor->count += added;
+            subtree_root = higher.root;
+        }
+        update_summaries_from_bottom_to_top(middle);
+        const bool grown = insert_fixup(middle, subtree_root);
+        return Subtree{subtree_root, higher.black_height + (grown ? 1 : 0)};
+    }
+
+    /**
+     * Splits the subtree into the keys less than key and the others.
+     */
+    std::pair<Subtree, Subtree> split_subtree(const Subtree &subtree, const Key &key) {
+        Node *unused = nullptr;
+        return split_subtree(subtree, key, unused, false);
+    }
+
+    /**
+     * With take_equal the node of the key is not put into any part, it is returned in equal.
+     */
+    std::pair<Subtree, Subtree> split_subtree(const Subtree &subtree, const Key &key, Node *&equal, bool take_equal) {
+        Node *node = subtree.root;
+        if (!node)
+            return {};
+        const auto left = child_subtree(subtree, node->left);
+        const auto right = child_subtree(subtree, node->right);
+        if (compare(node->key, key)) {
+            const auto [less, greater] = split_subtree(right, key, equal, take_equal);
+            return {join_subtrees(left, node, less), greater};
+        }
+        if (take_equal && !compare(key, node->key)) {
+            equal = node;
+            return {left, right};
+        }
+        const auto [less, greater] = split_subtree(left, key, equal, take_equal);
+        return {less, join_subtrees(greater, node, right)};
+    }
+
+    /**
+     * Takes the node of the largest key out of the non-empty subtree.
+     */
+    Subtree split_last(const Subtree &subtree, Node *&last) {
+        Node *node = subtree.root;
+        const auto left = child_subtree(subtree, node->left);
+        const auto right = child_subtree(subtree, node->right);
+        if (!right.root) {
+            last = node;
+            return left;
+        }
+        return join_subtrees(left, node, split_last(right, last));
+    }
+
+    Subtree unite_subtrees(const Subtree &first, const Subtree &second, std::size_t fork_depth) {
+        if (!first.root)
+            return second;
+        if (!second.root)
+            return first;
+        Node *node = first.root;
+        const bool fork = fork_depth > 0 && node->count + second.root->count >= 2 * PARALLEL_UNION_CUTOFF;
+        const auto left = child_subtree(first, node->left);
+        const auto right = child_subtree(first, node->right);
+        Node *equal = nullptr;
+        const auto [less, greater] = split_subtree(second, node->key, equal, true);
+        if (equal) {
+            if constexpr (AllowDuplicates)
+                node->multiplicity.value += equal->multiplicity.value;
+            destroy_node(equal);
+        }
+        Subtree united_left;
+        Subtree united_right;
+        if (fork) {
+            const Subtree second_less = less;
+            auto left_union = std::async(std::launch::async, [this, left, second_less, fork_depth] {
+                return unite_subtrees(left, second_less, fork_depth - 1);
+            });
+            united_right = unite_subtrees(right, greater, fork_depth - 1);
+            united_left = left_union.get();
+        } else {
+            united_left = unite_subtrees(left, less, 0);
+            united_right = unite_subtrees(right, greater, 0);
+        }
+        return join_subtrees(united_left, node, united_right);
+    }
+
+    /**
+     * Replaces the subtree of old_child with the subtree of new_child in the parent of old_child.
+     */
+    void transplant(Node *old_child, Node *new_child) {
+        const auto parent = old_child->parent;
+        if (!parent)
+            root = new_child;
+        else if (old_child == parent->left)
+            parent->left = new_child;
+        else
+            parent->right = new_child;
+        if (new_child)
+            new_child->parent = parent;
+    }
+
+    /**
+     * Removes the node with all its occurrences. The counts of the ancestors are decremented first,
+     * so the rotations of erase_fixup see correct counts.
+     */
+    void erase_node(Node *node) {
+        using Color = Node::Color;
+
+        const std::size_t removed = node->multiplicity.value;
+        auto removed_color = node->color;
+        Node *replacement;
+        Node *replacement_parent;
+        if (!node->left || !node->right) {
+            replacement = node->left ? node->left : node->right;
+            replacement_parent = node->parent;
+            decrement_from_bottom_to_top(node, removed);
+            transplant(node, replacement);
+        } else {
+            Node *next = leftmost(node->right);
+            removed_color = next->color;
+            replacement = next->right;
+            for (Node *cur = next->parent; cur != node; cur = cur->parent)
+                cur->count -= next->multiplicity.value;
+            decrement_from_bottom_to_top(node, removed);
+            if (next->parent == node) {
+                replacement_parent = next;
+            } else {
+                replacement_parent = next->parent;
+                transplant(next, next->right);
+                next->right = node->right;
+                next->right->parent = next;
+            }
+            transplant(node, next);
+            next->left = node->left;
+            next->left->parent = next;
+            next->color = node->color;
+            next->count = node->count - removed;
+        }
+        destroy_node(node);
+        count -= removed;
+        update_summaries_from_bottom_to_top(replacement_parent);
+        if (removed_color == Color::BLACK)
+            erase_fixup(replacement, replacement_parent);
+    }
+
+    static bool is_black(const Node *node) {
+        return !node || node->color == Node::Color::BLACK;
+    }
+
+    /**
+     * Restores the black height on the side of cur, which may be null, so its parent is passed too.
+     */
+    void erase_fixup(Node *cur, Node *parent) {
+        using Color = Node::Color;
+
+        while (cur != root && is_black(cur)) {
+            if (cur == parent->left) {
+                Node *sibling = parent->right;
+                if (sibling->color == Color::RED) {
+                    sibling->color = Color::BLACK;
+                    parent->color = Color::RED;
+                    parent->left_rotate(root);
+                    sibling = parent->right;
+                }
+                if (is_black(sibling->left) && is_black(sibling->right)) {
+                    sibling->color = Color::RED;
+                    cur = parent;
+                    parent = cur->parent;
+                } else {
+                    if (is_black(sibling->right)) {
+                        sibling->left->color = Color::BLACK;
+                        sibling->color = Color::RED;
+                        sibling->right_rotate(root);
+                        sibling = parent->right;
+                    }
+                    sibling->color = parent->color;
+                    parent->color = Color::BLACK;
+                    sibling->right->color = Color::BLACK;
+                    parent->left_rotate(root);
+                    cur = root;
+                }
+            } else {
+                Node *sibling = parent->left;
+                if (sibling->color == Color::RED) {
+                    sibling->color = Color::BLACK;
+                    parent->color = Color::RED;
+                    parent->right_rotate(root);
+                    sibling = parent->left;
+                }
+                if (is_black(sibling->left) && is_black(sibling->right)) {
+                    sibling->color = Color::RED;
+                    cur = parent;
+                    parent = cur->parent;
+                } else {
+                    if (is_black(sibling->left)) {
+                        sibling->right->color = Color::BLACK;
+                        sibling->color = Color::RED;
+                        sibling->left_rotate(root);
+                        sibling = parent->left;
+                    }
+                    sibling->color = parent->color;
+                    parent->color = Color::BLACK;
+                    sibling->left->color = Color::BLACK;
+                    parent->right_rotate(root);
+                    cur = root;
+                }
+            }
+        }
+        if (cur)
+            cur->color = Color::BLACK;
+    }
+
+    /**
+     * Restores the red-black invariant above a red node in the subtree of root_node.
+     * Returns true if a red root was painted black, i.e. the black height has grown.
+     */
+    static bool insert_fixup(Node *added, Node *&root_node) {
         using Color = Node::Color;
 
         auto cur = added;
@@ -295,11 +1269,11 @@ private:
                 } else {
                     if (cur == parent->right) {
                         std::swap(cur, parent);
-                        cur->left_rotate(root);
+                        cur->left_rotate(root_node);
                     }
                     parent->color = Color::BLACK;
                     grandpa->color = Color::RED;
-                    grandpa->right_rotate(root);
+                    grandpa->right_rotate(root_node);
                 }
             } else {
                 const auto uncle = grandpa->left;
@@ -311,48 +1285,86 @@ private:
                 } else {
                     if (cur == parent->left) {
                         std::swap(cur, parent);
-                        cur->right_rotate(root);
+                        cur->right_rotate(root_node);
                     }
                     parent->color = Color::BLACK;
                     grandpa->color = Color::RED;
-                    grandpa->left_rotate(root);
+                    grandpa->left_rotate(root_node);
                 }
             }
             parent = cur->parent;
         }
-        root->color = Color::BLACK;
+        const bool grown = root_node->color == Color::RED;
+        root_node->color = Color::BLACK;
+        return grown;
     }
 
-    [[nodiscard]] int find_order_statistic(const Node *node, std::size_t k) const {
-        const std::size_t left_size = node->left_count();
-        if (k == left_size + 1)
-            return node->key;
-        else if (k <= left_size)
-            return find_order_statistic(node->left, k);
-        else
-            return find_order_statistic(node->right, k - left_size - 1);
+    /** Query of a batch in progress: the node to visit and the accumulated result or the remaining rank. */
+    struct BatchLane {
+        const Node *node;
+        std::size_t query;
+        std::size_t result;
+    };
+
+    /**
+     * Runs query_count queries in BATCH_LANES lanes. A lane starts at the root
+     * with the result start(query), step advances it by one level and sets its node to null
+     * when the query is answered, then the lane takes the next query.
+     * The children of a lane's node are always prefetched one round before the step reads them.
+     */
+    template<class Start, class Step>
+    void run_batch(std::size_t query_count, Start start, Step step) const {
+        std::array<BatchLane, BATCH_LANES> lanes;
+        std::size_t active = 0;
+        std::size_t next_query = 0;
+        prefetch_children(root);
+        while (active < BATCH_LANES && next_query < query_count) {
+            lanes[active++] = BatchLane{root, next_query, start(next_query)};
+            next_query++;
+        }
+        while (active > 0) {
+            for (std::size_t i = 0; i < active;) {
+                auto &lane = lanes[i];
+                step(lane);
+                if (lane.node) {
+                    prefetch_children(lane.node);
+                    i++;
+                } else if (next_query < query_count) {
+                    lane = BatchLane{root, next_query, start(next_query)};
+                    next_query++;
+                    i++;
+                } else {
+                    lane = lanes[--active];
+                }
+            }
+        }
+    }
+
+    static void prefetch_children(const Node *node) {
+        __builtin_prefetch(node->left);
+        __builtin_prefetch(node->right);
     }
 
-    static void increment_from_bottom_to_top(const Node *added) {
-        auto parent = added->parent;
+    static void decrement_from_bottom_to_top(const Node *node, std::size_t amount) {
+        auto parent = node->parent;
         while (parent) {
-            parent->count++;
+            parent->count -= amount;
             parent = parent->parent;
         }
     }
 
-    [[nodiscard]] Node *find_position_to_add(int key) const {
-        Node *parent = nullptr;
-        Node *cur = root;
-        while (cur) {
-            parent = cur;
-            if (key < cur->key)
-                cur = cur->left;
-            else
-                cur = cur->right;
+    /**
+     * Recomputes the augmentation of the node and its ancestors after a change below them.
+     */
+    static void update_summaries_from_bottom_to_top(Node *node) {
+        if constexpr (AUGMENTED) {
+            for (; node; node = node->parent)
+                node->update_summary();
         }
-        return parent;
     }
 };
 
+using OrderStatisticTree = BasicOrderStatisticTree<>;
+using OrderStatisticMultiset = BasicOrderStatisticTree<int, std::less<int>, NoAugmentation, std::allocator<int>, true>;
+
 #endif //ORDER_STATISTIC_TREE_H
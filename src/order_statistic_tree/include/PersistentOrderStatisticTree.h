@@ -0,0 +1,318 @@
+#ifndef ORDER_STATISTIC_TREE_PERSISTENTORDERSTATISTICTREE_H
+#define ORDER_STATISTIC_TREE_PERSISTENTORDERSTATISTICTREE_H
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/**
+ * Persistent order statistic tree: nodes are immutable and shared between versions.
+ *
+ * A change copies only the O(log n) nodes on the path to the key, so copying the tree
+ * is an O(1) snapshot that is not affected by the later changes. The tree is weight-balanced
+ * (Adams' trees with delta = 3, ratio = 2): the subtree counts are the balance information,
+ * so no colors are needed. Nodes are reference counted, a snapshot may be read from another thread.
+ */
+template<class Allocator = std::allocator<int>>
+class BasicPersistentOrderStatisticTree {
+protected:
+    struct Node;
+
+    using NodePointer = std::shared_ptr<const Node>;
+
+    struct Node {
+        int key;
+        std::size_t count;
+        NodePointer left;
+        NodePointer right;
+
+        Node(int key, NodePointer left, NodePointer right) :
+                key(key), count(1 + size(left) + size(right)), left(std::move(left)), right(std::move(right)) {}
+    };
+
+    using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+
+    static constexpr std::size_t DELTA = 3;
+    static constexpr std::size_t RATIO = 2;
+
+    NodePointer root;
+    NodeAllocator allocator;
+
+public:
+    BasicPersistentOrderStatisticTree() = default;
+
+    /**
+     * Returns false if the key already exists, then nothing is copied.
+     */
+    bool insert(int key) {
+        bool inserted = false;
+        auto new_root = insert(root, key, inserted);
+        if (inserted)
+            root = std::move(new_root);
+        return inserted;
+    }
+
+    /**
+     * Returns the number of erased keys: 0 or 1.
+     */
+    std::size_t erase(int key) {
+        bool erased = false;
+        auto new_root = erase(root, key, erased);
+        if (erased)
+            root = std::move(new_root);
+        return erased ? 1 : 0;
+    }
+
+    /**
+     * O(1) copy that shares all nodes with this tree.
+     */
+    [[nodiscard]] BasicPersistentOrderStatisticTree snapshot() const {
+        return *this;
+    }
+
+    [[nodiscard]] bool contains(int key) const {
+        const Node *cur = root.get();
+        while (cur) {
+            if (key < cur->key)
+                cur = cur->left.get();
+            else if (cur->key < key)
+                cur = cur->right.get();
+            else
+                return true;
+        }
+        return false;
+    }
+
+    [[nodiscard]] std::size_t less_count(int key) const {
+        std::size_t lower_count = 0;
+        const Node *cur = root.get();
+        while (cur) {
+            if (cur->key < key) {
+                lower_count += size(cur->left) + 1;
+                cur = cur->right.get();
+            } else {
+                cur = cur->left.get();
+            }
+        }
+        return lower_count;
+    }
+
+    [[nodiscard]] int find_order_statistic(std::size_t k) const {
+        if (k == 0 || k > size())
+            throw std::logic_error("k must be from 1 to tree size!");
+        const Node *cur = root.get();
+        while (true) {
+            const std::size_t left_size = size(cur->left);
+            if (k <= left_size) {
+                cur = cur->left.get();
+            } else if (k == left_size + 1) {
+                return cur->key;
+            } else {
+                k -= left_size + 1;
+                cur = cur->right.get();
+            }
+        }
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return size(root);
+    }
+
+    [[nodiscard]] bool empty() const {
+        return !root;
+    }
+
+    void clear() {
+        root.reset();
+    }
+
+    /**
+     * Trees are equal if they hold the same keys, whatever their shape is.
+     */
+    bool operator==(const BasicPersistentOrderStatisticTree &other) const {
+        return root == other.root || sorted_keys() == other.sorted_keys();
+    }
+
+    [[nodiscard]] std::vector<int> sorted_keys() const {
+        std::vector<int> keys;
+        keys.reserve(size());
+        append_keys(root.get(), keys);
+        return keys;
+    }
+
+private:
+    static std::size_t size(const NodePointer &node) {
+        return node ? node->count : 0;
+    }
+
+    NodePointer make_node(int key, NodePointer left, NodePointer right) const {
+        return std::allocate_shared<Node>(allocator, key, std::move(left), std::move(right));
+    }
+
+    /**
+     * Builds a node from subtrees that were balanced before one of them changed by one key.
+     */
+    NodePointer balance(int key, NodePointer left, NodePointer right) const {
+        const std::size_t left_size = size(left);
+        const std::size_t right_size = size(right);
+        if (left_size + right_size <= 1)
+            return make_node(key, std::move(left), std::move(right));
+        if (right_size > DELTA * left_size)
+            return rotate_left(key, std::move(left), std::move(right));
+        if (left_size > DELTA * right_size)
+            return rotate_right(key, std::move(left), std::move(right));
+        return make_node(key, std::move(left), std::move(right));
+    }
+
+    NodePointer rotate_left(int key, NodePointer left, NodePointer right) const {
+        if (size(right->left) < RATIO * size(right->right))
+            return make_node(right->key, make_node(key, std::move(left), right->left), right->right);
+        const auto &middle = right->left;
+        return make_node(middle->key,
+                         make_node(key, std::move(left), middle->left),
+                         make_node(right->key, middle->right, right->right));
+    }
+
+    NodePointer rotate_right(int key, NodePointer left, NodePointer right) const {
+        if (size(left->right) < RATIO * size(left->left))
+            return make_node(left->key, left->left, make_node(key, left->right, std::move(right)));
+        const auto &middle = left->right;
+        return make_node(middle->key,
+                         make_node(left->key, left->left, middle->left),
+                         make_node(key, middle->right, std::move(right)));
+    }
+
+    NodePointer insert(const NodePointer &node, int key, bool &inserted) const {
+        if (!node) {
+            inserted = true;
+            return make_node(key, nullptr, nullptr);
+        }
+        if (key < node->key) {
+            auto left = insert(node->left, key, inserted);
+            return inserted ? balance(node->key, std::move(left), node->right) : node;
+        }
+        if (node->key < key) {
+            auto right = insert(node->right, key, inserted);
+            return inserted ? balance(node->key, node->left, std::move(right)) : node;
+        }
+        return node;
+    }
+
+    NodePointer erase(const NodePointer &node, int key, bool &erased) const {
+        if (!node)
+            return nullptr;
+        if (key < node->key) {
+            auto left = erase(node->left, key, erased);
+            return erased ? balance(node->key, std::move(left), node->right) : node;
+        }
+        if (node->key < key) {
+            auto right = erase(node->right, key, erased);
+            return erased ? balance(node->key, node->left, std::move(right)) : node;
+        }
+        erased = true;
+        return glue(node->left, node->right);
+    }
+
+    /**
+     * Joins the subtrees of a removed node, taking the replacement from the bigger one.
+     */
+    NodePointer glue(const NodePointer &left, const NodePointer &right) const {
+        if (!left)
+            return right;
+        if (!right)
+            return left;
+        if (size(left) > size(right)) {
+            int max_key;
+            auto rest = erase_max(left, max_key);
+            return balance(max_key, std::move(rest), right);
+        }
+        int min_key;
+        auto rest = erase_min(right, min_key);
+        return balance(min_key, left, std::move(rest));
+    }
+
+    NodePointer erase_min(const NodePointer &node, int &min_key) const {
+        if (!node->left) {
+            min_key = node->key;
+            return node->right;
+        }
+        return balance(node->key, erase_min(node->left, min_key), node->right);
+    }
+
+    NodePointer erase_max(const NodePointer &node, int &max_key) const {
+        if (!node->right) {
+            max_key = node->key;
+            return node->left;
+        }
+        return balance(node->key, node->left, erase_max(node->right, max_key));
+    }
+
+    static void append_keys(const Node *node, std::vector<int> &keys) {
+        if (!node)
+            return;
+        append_keys(node->left.get(), keys);
+        keys.push_back(node->key);
+        append_keys(node->right.get(), keys);
+    }
+};
+
+using PersistentOrderStatisticTree = BasicPersistentOrderStatisticTree<>;
+
+/**
+ * History of a persistent tree. Version 0 is the empty tree, every successful change adds a version,
+ * so queries can be answered for any past state, e.g. the rank of a key as of version v.
+ */
+template<class Allocator = std::allocator<int>>
+class BasicVersionedOrderStatisticTree {
+public:
+    using Tree = BasicPersistentOrderStatisticTree<Allocator>;
+
+    BasicVersionedOrderStatisticTree() : versions(1) {}
+
+    bool insert(int key) {
+        auto next = versions.back();
+        if (!next.insert(key))
+            return false;
+        versions.push_back(std::move(next));
+        return true;
+    }
+
+    std::size_t erase(int key) {
+        auto next = versions.back();
+        if (next.erase(key) == 0)
+            return 0;
+        versions.push_back(std::move(next));
+        return 1;
+    }
+
+    [[nodiscard]] std::size_t current_version() const {
+        return versions.size() - 1;
+    }
+
+    [[nodiscard]] const Tree &at(std::size_t version) const {
+        if (version >= versions.size())
+            throw std::out_of_range("There is no such version!");
+        return versions[version];
+    }
+
+    [[nodiscard]] const Tree &current() const {
+        return versions.back();
+    }
+
+    [[nodiscard]] std::size_t less_count(int key, std::size_t version) const {
+        return at(version).less_count(key);
+    }
+
+    [[nodiscard]] int find_order_statistic(std::size_t k, std::size_t version) const {
+        return at(version).find_order_statistic(k);
+    }
+
+private:
+    std::vector<Tree> versions;
+};
+
+using VersionedOrderStatisticTree = BasicVersionedOrderStatisticTree<>;
+
+#endif //ORDER_STATISTIC_TREE_PERSISTENTORDERSTATISTICTREE_H
@@ -0,0 +1,167 @@
+#ifndef ORDER_STATISTIC_TREE_SIMDKERNELS_H
+#define ORDER_STATISTIC_TREE_SIMDKERNELS_H
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__)
+#define ORDER_STATISTIC_TREE_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+/**
+ * In-node kernels of the wide-node trees:
+ * * count_less - number of keys lower than the given one;
+ * * find_rank_child - first child whose prefix sum of counts reaches k.
+ *
+ * Every kernel has a scalar version and, on x86, SSE4.2 and AVX2 versions
+ * compiled with target attributes. The dispatching functions pick the best
+ * version for the running CPU once.
+ */
+
+using CountLessKernel = std::size_t (*)(const int *keys, std::size_t n, int key);
+
+/**
+ * Decreases k by the counts of the skipped children. If k exceeds the sum of counts,
+ * every version returns the last child, n - 1.
+ */
+using FindRankChildKernel = std::size_t (*)(const std::size_t *counts, std::size_t n, std::size_t &k);
+
+inline std::size_t count_less_scalar(const int *keys, std::size_t n, int key) {
+    std::size_t result = 0;
+    for (std::size_t i = 0; i < n; i++)
+        result += keys[i] < key;
+    return result;
+}
+
+inline std::size_t find_rank_child_scalar(const std::size_t *counts, std::size_t n, std::size_t &k) {
+    std::size_t i = 0;
+    while (i + 1 < n && k > counts[i]) {
+        k -= counts[i];
+        i++;
+    }
+    return i;
+}
+
+#ifdef ORDER_STATISTIC_TREE_X86_KERNELS
+
+__attribute__((target("sse4.2")))
+inline std::size_t count_less_sse(const int *keys, std::size_t n, int key) {
+    const __m128i key_vector = _mm_set1_epi32(key);
+    std::size_t result = 0;
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i));
+        const __m128i less = _mm_cmpgt_epi32(key_vector, values);
+        result += std::popcount(static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(less))));
+    }
+    return result + count_less_scalar(keys + i, n - i, key);
+}
+
+__attribute__((target("avx2")))
+inline std::size_t count_less_avx2(const int *keys, std::size_t n, int key) {
+    const __m256i key_vector = _mm256_set1_epi32(key);
+    std::size_t result = 0;
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i));
+        const __m256i less = _mm256_cmpgt_epi32(key_vector, values);
+        result += std::popcount(static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(less))));
+    }
+    return result + count_less_sse(keys + i, n - i, key);
+}
+
+__attribute__((target("sse4.2")))
+inline std::size_t find_rank_child_sse(const std::size_t *counts, std::size_t n, std::size_t &k) {
+    const __m128i k_vector = _mm_set1_epi64x(static_cast<long long>(k));
+    __m128i total = _mm_setzero_si128();
+    std::size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(counts + i));
+        const __m128i prefix = _mm_add_epi64(_mm_add_epi64(values, _mm_slli_si128(values, 8)), total);
+        const __m128i less = _mm_cmpgt_epi64(k_vector, prefix);
+        const auto less_mask = static_cast<unsigned>(_mm_movemask_pd(_mm_castsi128_pd(less)));
+        if (less_mask != 0b11) {
+            const auto lane = static_cast<std::size_t>(std::popcount(less_mask));
+            k -= lane == 0 ? static_cast<std::size_t>(_mm_cvtsi128_si64(total))
+                           : static_cast<std::size_t>(_mm_cvtsi128_si64(prefix));
+            return i + lane;
+        }
+        total = _mm_unpackhi_epi64(prefix, prefix);
+    }
+    k -= static_cast<std::size_t>(_mm_cvtsi128_si64(total));
+    if (i == n && n > 0) {
+        k += counts[n - 1];
+        return n - 1;
+    }
+    return i + find_rank_child_scalar(counts + i, n - i, k);
+}
+
+__attribute__((target("avx2")))
+inline std::size_t find_rank_child_avx2(const std::size_t *counts, std::size_t n, std::size_t &k) {
+    const __m256i k_vector = _mm256_set1_epi64x(static_cast<long long>(k));
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i total = zero;
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i prefix = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(counts + i));
+        prefix = _mm256_add_epi64(prefix, _mm256_blend_epi32(
+                _mm256_permute4x64_epi64(prefix, 0b10010000), zero, 0b00000011));
+        prefix = _mm256_add_epi64(prefix, _mm256_blend_epi32(
+                _mm256_permute4x64_epi64(prefix, 0b01000000), zero, 0b00001111));
+        prefix = _mm256_add_epi64(prefix, total);
+        const __m256i less = _mm256_cmpgt_epi64(k_vector, prefix);
+        const auto less_mask = static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(less)));
+        if (less_mask != 0b1111) {
+            const auto lane = static_cast<std::size_t>(std::popcount(less_mask));
+            alignas(32) std::size_t prefixes[4];
+            _mm256_store_si256(reinterpret_cast<__m256i *>(prefixes), prefix);
+            k -= lane == 0 ? prefixes[0] - counts[i] : prefixes[lane - 1];
+            return i + lane;
+        }
+        total = _mm256_permute4x64_epi64(prefix, 0b11111111);
+    }
+    k -= static_cast<std::size_t>(_mm256_extract_epi64(total, 0));
+    if (i == n && n > 0) {
+        k += counts[n - 1];
+        return n - 1;
+    }
+    return i + find_rank_child_scalar(counts + i, n - i, k);
+}
+
+#endif //ORDER_STATISTIC_TREE_X86_KERNELS
+
+inline CountLessKernel select_count_less_kernel() {
+#ifdef ORDER_STATISTIC_TREE_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return count_less_avx2;
+    if (__builtin_cpu_supports("sse4.2"))
+        return count_less_sse;
+#endif
+    return count_less_scalar;
+}
+
+inline FindRankChildKernel select_find_rank_child_kernel() {
+#ifdef ORDER_STATISTIC_TREE_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return find_rank_child_avx2;
+    if (__builtin_cpu_supports("sse4.2"))
+        return find_rank_child_sse;
+#endif
+    return find_rank_child_scalar;
+}
+
+inline std::size_t count_less(const int *keys, std::size_t n, int key) {
+    static const CountLessKernel kernel = select_count_less_kernel();
+    return kernel(keys, n, key);
+}
+
+inline std::size_t find_rank_child(const std::size_t *counts, std::size_t n, std::size_t &k) {
+    static const FindRankChildKernel kernel = select_find_rank_child_kernel();
+    return kernel(counts, n, k);
+}
+
+#endif //ORDER_STATISTIC_TREE_SIMDKERNELS_H
@@ -0,0 +1,290 @@
+#ifndef ORDER_STATISTIC_TREE_TREESNAPSHOT_H
+#define ORDER_STATISTIC_TREE_TREESNAPSHOT_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "FileSync.h"
+
+/**
+ * File format of the tree snapshots, MappedOrderStatisticTree answers queries from the mapped file as is.
+ *
+ * A snapshot is a TreeSnapshotHeader, the keys in increasing order and the rank index, every section
+ * starts at a multiple of SNAPSHOT_ALIGNMENT bytes. The index is the Eytzinger (BFS) layout of the first key
+ * of every block of SNAPSHOT_BLOCK_SIZE keys, followed by the block numbers of the index entries:
+ * a query descends the implicit tree and then scans one block of the sorted keys.
+ * Numbers are stored in the byte order of the writer, a file of another byte order is rejected.
+ * The header keeps a checksum of the bytes after it: read_tree_snapshot verifies it, a mapped snapshot
+ * is not read as a whole and is trusted.
+ */
+struct TreeSnapshotHeader {
+    std::array<char, 8> magic;
+    std::uint32_t byte_order;
+    std::uint32_t version;
+    std::uint32_t key_size;
+    std::uint32_t block_size;
+    std::uint64_t key_count;
+    std::uint64_t checksum;
+};
+
+inline constexpr std::array<char, 8> SNAPSHOT_MAGIC = {'O', 'S', 'T', 'S', 'N', 'A', 'P', '\0'};
+inline constexpr std::uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+inline constexpr std::uint32_t SNAPSHOT_VERSION = 2;
+inline constexpr std::size_t SNAPSHOT_BLOCK_SIZE = 16;
+inline constexpr std::size_t SNAPSHOT_ALIGNMENT = 64;
+inline constexpr std::uint64_t SNAPSHOT_CHECKSUM_SEED = 0xcbf29ce484222325;
+
+/**
+ * Continues the checksum (64-bit FNV-1a) of the preceding bytes with size bytes of data.
+ */
+inline std::uint64_t update_snapshot_checksum(std::uint64_t checksum, const void *data, std::size_t size) {
+    static constexpr std::uint64_t PRIME = 0x100000001b3;
+    const auto *bytes = static_cast<const unsigned char *>(data);
+    for (std::size_t i = 0; i < size; i++)
+        checksum = (checksum ^ bytes[i]) * PRIME;
+    return checksum;
+}
+
+/**
+ * Continues the checksum with the next size bytes of the input, the input fails if it is shorter.
+ */
+inline std::uint64_t update_snapshot_checksum(std::uint64_t checksum, std::istream &input, std::size_t size) {
+    std::array<char, 1 << 14> chunk{};
+    while (size > 0 && input) {
+        const auto length = std::min(size, chunk.size());
+        input.read(chunk.data(), static_cast<std::streamsize>(length));
+        checksum = update_snapshot_checksum(checksum, chunk.data(), static_cast<std::size_t>(input.gcount()));
+        size -= length;
+    }
+    return checksum;
+}
+
+/**
+ * Offsets of the snapshot sections in bytes.
+ */
+struct TreeSnapshotLayout {
+    std::size_t keys_offset;
+    std::size_t index_offset;
+    std::size_t blocks_offset;
+    std::size_t index_size;
+    std::size_t file_size;
+
+    static TreeSnapshotLayout of(std::size_t key_count, std::size_t key_size) {
+        const auto align = [](std::size_t offset) {
+            return (offset + SNAPSHOT_ALIGNMENT - 1) / SNAPSHOT_ALIGNMENT * SNAPSHOT_ALIGNMENT;
+        };
+        TreeSnapshotLayout layout{};
+        layout.index_size = (key_count + SNAPSHOT_BLOCK_SIZE - 1) / SNAPSHOT_BLOCK_SIZE;
+        layout.keys_offset = align(sizeof(TreeSnapshotHeader));
+        layout.index_offset = align(layout.keys_offset + key_count * key_size);
+        layout.blocks_offset = align(layout.index_offset + layout.index_size * key_size);
+        layout.file_size = layout.blocks_offset + layout.index_size * sizeof(std::uint32_t);
+        return layout;
+    }
+};
+
+/**
+ * Checks that the header describes a snapshot of Key that takes exactly file_size bytes.
+ * Throws std::runtime_error otherwise.
+ */
+template<class Key>
+TreeSnapshotLayout validate_snapshot_header(const TreeSnapshotHeader &header, std::size_t file_size) {
+    if (header.magic != SNAPSHOT_MAGIC)
+        throw std::runtime_error("The file is not a tree snapshot!");
+    if (header.byte_order != SNAPSHOT_BYTE_ORDER)
+        throw std::runtime_error("The snapshot was written with another byte order!");
+    if (header.version != SNAPSHOT_VERSION)
+        throw std::runtime_error("Unsupported snapshot version: " + std::to_string(header.version) + "!");
+    if (header.key_size != sizeof(Key) || header.block_size != SNAPSHOT_BLOCK_SIZE)
+        throw std::runtime_error("The snapshot was written for another key type!");
+    if (header.key_count > (file_size - std::min(file_size, sizeof(TreeSnapshotHeader))) / sizeof(Key))
+        throw std::runtime_error("The snapshot is truncated!");
+    const auto layout = TreeSnapshotLayout::of(header.key_count, sizeof(Key));
+    if (layout.file_size != file_size)
+        throw std::runtime_error("The snapshot is truncated!");
+    return layout;
+}
+
+namespace tree_snapshot_detail {
+    template<class T>
+    void write_array(std::ofstream &output, std::uint64_t &checksum, const T *values, std::size_t n) {
+        output.write(reinterpret_cast<const char *>(values), static_cast<std::streamsize>(n * sizeof(T)));
+        checksum = update_snapshot_checksum(checksum, values, n * sizeof(T));
+    }
+
+    inline void pad_to(std::ofstream &output, std::uint64_t &checksum, std::size_t written, std::size_t offset) {
+        static constexpr std::array<char, SNAPSHOT_ALIGNMENT> zeros{};
+        write_array(output, checksum, zeros.data(), offset - written);
+    }
+
+    /**
+     * File that a snapshot is written to before it is renamed over the target, removed if the save fails.
+     */
+    class TemporaryFile {
+    public:
+        explicit TemporaryFile(std::filesystem::path path) : path(std::move(path)) {}
+
+        TemporaryFile(const TemporaryFile &) = delete;
+
+        TemporaryFile &operator=(const TemporaryFile &) = delete;
+
+        ~TemporaryFile() {
+            if (!renamed) {
+                std::error_code error;
+                std::filesystem::remove(path, error);
+            }
+        }
+
+        void rename_to(const std::filesystem::path &target) {
+            std::filesystem::rename(path, target);
+            renamed = true;
+        }
+
+    private:
+        std::filesystem::path path;
+        bool renamed = false;
+    };
+
+    /**
+     * Lays out the sorted samples in the BFS order of a complete binary tree (1-based node numbers).
+     */
+    template<class Key>
+    void fill_eytzinger(const std::vector<Key> &samples, std::vector<Key> &index, std::vector<std::uint32_t> &blocks,
+                        std::size_t &next, std::size_t node) {
+        if (node > samples.size())
+            return;
+        fill_eytzinger(samples, index, blocks, next, 2 * node);
+        index[node - 1] = samples[next];
+        blocks[node - 1] = static_cast<std::uint32_t>(next);
+        next++;
+        fill_eytzinger(samples, index, blocks, next, 2 * node + 1);
+    }
+}
+
+/**
+ * Writes key_count keys of [first, last) in increasing order as a snapshot. The file is written next to path,
+ * synced and renamed over it at the end, so neither a failed save nor a crash leaves a torn snapshot at path,
+ * and a failed save removes the temporary file. The rename is synced too: the snapshot is durable
+ * when the function returns.
+ * Throws std::runtime_error if the file can't be written.
+ */
+template<class Key, class Iterator>
+void write_tree_snapshot(const std::filesystem::path &path, Iterator first, Iterator last, std::size_t key_count) {
+    static_assert(std::is_trivially_copyable_v<Key>, "Snapshot keys are copied as bytes");
+    static constexpr std::size_t CHUNK_SIZE = 1 << 14;
+
+    const auto layout = TreeSnapshotLayout::of(key_count, sizeof(Key));
+    if (layout.index_size > UINT32_MAX)
+        throw std::runtime_error("Too many keys for a snapshot!");
+    auto temporary_path = path;
+    temporary_path += ".tmp";
+    tree_snapshot_detail::TemporaryFile temporary_file(temporary_path);
+    std::ofstream output(temporary_path, std::ios::binary | std::ios::trunc);
+    if (!output)
+        throw std::runtime_error("Can't create the snapshot " + temporary_path.string() + "!");
+
+    // The checksum is known at the end, the header is written again then.
+    TreeSnapshotHeader header{SNAPSHOT_MAGIC, SNAPSHOT_BYTE_ORDER, SNAPSHOT_VERSION,
+                              static_cast<std::uint32_t>(sizeof(Key)),
+                              static_cast<std::uint32_t>(SNAPSHOT_BLOCK_SIZE), key_count, 0};
+    output.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    std::uint64_t checksum = SNAPSHOT_CHECKSUM_SEED;
+    tree_snapshot_detail::pad_to(output, checksum, sizeof(header), layout.keys_offset);
+
+    std::vector<Key> samples;
+    samples.reserve(layout.index_size);
+    std::vector<Key> chunk;
+    chunk.reserve(CHUNK_SIZE);
+    std::size_t written = 0;
+    for (; first != last; ++first) {
+        if (written++ % SNAPSHOT_BLOCK_SIZE == 0)
+            samples.push_back(*first);
+        chunk.push_back(*first);
+        if (chunk.size() == CHUNK_SIZE) {
+            tree_snapshot_detail::write_array(output, checksum, chunk.data(), chunk.size());
+            chunk.clear();
+        }
+    }
+    if (written != key_count)
+        throw std::logic_error("The key count doesn't match the keys!");
+    tree_snapshot_detail::write_array(output, checksum, chunk.data(), chunk.size());
+    tree_snapshot_detail::pad_to(output, checksum, layout.keys_offset + key_count * sizeof(Key), layout.index_offset);
+
+    std::vector<Key> index(samples.size());
+    std::vector<std::uint32_t> blocks(samples.size());
+    std::size_t next = 0;
+    tree_snapshot_detail::fill_eytzinger(samples, index, blocks, next, 1);
+    tree_snapshot_detail::write_array(output, checksum, index.data(), index.size());
+    tree_snapshot_detail::pad_to(output, checksum, layout.index_offset + index.size() * sizeof(Key),
+                                 layout.blocks_offset);
+    tree_snapshot_detail::write_array(output, checksum, blocks.data(), blocks.size());
+    header.checksum = checksum;
+    output.seekp(0);
+    output.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    output.close();
+    if (!output)
+        throw std::runtime_error("Can't write the snapshot " + temporary_path.string() + "!");
+    // Without the sync the rename may reach the disk before the data and a crash leaves a torn file at path.
+    sync_path(temporary_path, O_RDONLY);
+    temporary_file.rename_to(path);
+    const auto directory = path.parent_path();
+    sync_path(directory.empty() ? "." : directory, O_RDONLY | O_DIRECTORY);
+}
+
+/**
+ * Reads the keys of a snapshot in increasing order and verifies the checksum of the file.
+ * Throws std::runtime_error if the file can't be read, is corrupted or is not a snapshot of Key.
+ */
+template<class Key>
+std::vector<Key> read_tree_snapshot(const std::filesystem::path &path) {
+    static_assert(std::is_trivially_copyable_v<Key>, "Snapshot keys are copied as bytes");
+    std::ifstream input(path, std::ios::binary);
+    if (!input)
+        throw std::runtime_error("Can't open the snapshot " + path.string() + "!");
+    TreeSnapshotHeader header{};
+    input.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (!input)
+        throw std::runtime_error("The file is not a tree snapshot!");
+    const auto layout = validate_snapshot_header<Key>(header, std::filesystem::file_size(path));
+    std::vector<Key> keys(header.key_count);
+    const auto keys_size = keys.size() * sizeof(Key);
+    auto checksum = update_snapshot_checksum(SNAPSHOT_CHECKSUM_SEED, input, layout.keys_offset - sizeof(header));
+    input.read(reinterpret_cast<char *>(keys.data()), static_cast<std::streamsize>(keys_size));
+    checksum = update_snapshot_checksum(checksum, keys.data(), keys_size);
+    checksum = update_snapshot_checksum(checksum, input, layout.file_size - layout.keys_offset - keys_size);
+    if (!input)
+        throw std::runtime_error("Can't read the snapshot " + path.string() + "!");
+    if (checksum != header.checksum)
+        throw std::runtime_error("The snapshot is corrupted!");
+    return keys;
+}
+
+/**
+ * Writes the keys of a tree in increasing order to a snapshot file, MappedOrderStatisticTree can query it in place.
+ */
+template<class Tree>
+void save_tree_snapshot(const Tree &tree, const std::filesystem::path &path) {
+    write_tree_snapshot<typename Tree::key_type>(path, tree.begin(), tree.end(), tree.size());
+}
+
+/**
+ * Builds a tree from a snapshot file by Tree::build_from_sorted, in O(n) for BasicOrderStatisticTree.
+ */
+template<class Tree>
+Tree load_tree_snapshot(const std::filesystem::path &path,
+                        const typename Tree::key_compare &compare = typename Tree::key_compare()) {
+    return Tree::build_from_sorted(read_tree_snapshot<typename Tree::key_type>(path), compare);
+}
+
+#endif //ORDER_STATISTIC_TREE_TREESNAPSHOT_H
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include <climits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BinaryProtocol.h"
+#include "CliOptions.h"
+
+extern int run(const CliOptions &options);
+
+static void add_record(std::string &input, char code, std::int64_t value) {
+    char bytes[BINARY_RECORD_SIZE];
+    encode_record(BinaryRecord{static_cast<std::uint8_t>(code), value}, bytes);
+    input.append(bytes, BINARY_RECORD_SIZE);
+}
+
+static std::vector<BinaryRecord> run_binary(const std::string &input, int expected_code = 0) {
+    std::istringstream input_stream(input);
+    std::ostringstream output_stream;
+    const auto old_input = std::cin.rdbuf();
+    const auto old_output = std::cout.rdbuf();
+    std::cin.rdbuf(input_stream.rdbuf());
+    std::cout.rdbuf(output_stream.rdbuf());
+    CliOptions options;
+    options.binary = true;
+    EXPECT_EQ(expected_code, run(options));
+    std::cin.rdbuf(old_input);
+    std::cout.rdbuf(old_output);
+
+    const auto output = output_stream.str();
+    EXPECT_EQ(0, output.size() % BINARY_RECORD_SIZE);
+    std::vector<BinaryRecord> responses;
+    for (std::size_t i = 0; i + BINARY_RECORD_SIZE <= output.size(); i += BINARY_RECORD_SIZE)
+        responses.push_back(decode_record(output.data() + i));
+    return responses;
+}
+
+static void expect_response(const BinaryRecord &response, BinaryStatus status, std::int64_t value = 0) {
+    EXPECT_EQ(static_cast<std::uint8_t>(status), response.code);
+    EXPECT_EQ(value, response.value);
+}
+
+TEST(BinaryProtocolTest, RecordsAreLittleEndian) {
+    char bytes[BINARY_RECORD_SIZE];
+    encode_record(BinaryRecord{'n', -2}, bytes);
+    EXPECT_EQ('n', bytes[0]);
+    for (std::size_t i = 1; i < 8; i++)
+        EXPECT_EQ(0, bytes[i]);
+    EXPECT_EQ(static_cast<char>(0xFE), bytes[8]);
+    for (std::size_t i = 9; i < BINARY_RECORD_SIZE; i++)
+        EXPECT_EQ(static_cast<char>(0xFF), bytes[i]);
+
+    for (const std::int64_t value: {std::int64_t{0}, std::int64_t{1} << 40, std::int64_t{INT_MIN}, INT64_MAX}) {
+        encode_record(BinaryRecord{'k', value}, bytes);
+        EXPECT_EQ(value, decode_record(bytes).value);
+    }
+}
+
+TEST(BinaryProtocolTest, AnswersQueries) {
+    std::string input;
+    for (const int key: {5, 1, 9})
+        add_record(input, 'k', key);
+    add_record(input, 'k', 5);
+    add_record(input, 'd', 9);
+    add_record(input, 'd', 9);
+    add_record(input, 'm', 2);
+    add_record(input, 'm', 3);
+    add_record(input, 'm', 0);
+    add_record(input, 'n', 6);
+
+    const auto responses = run_binary(input);
+    ASSERT_EQ(10, responses.size());
+    for (std::size_t i = 0; i < 3; i++)
+        expect_response(responses[i], BinaryStatus::OK);
+    expect_response(responses[3], BinaryStatus::KEY_EXISTS);
+    expect_response(responses[4], BinaryStatus::OK);
+    expect_response(responses[5], BinaryStatus::KEY_NOT_FOUND);
+    expect_response(responses[6], BinaryStatus::OK, 5);
+    expect_response(responses[7], BinaryStatus::RANK_OUT_OF_RANGE);
+    expect_response(responses[8], BinaryStatus::RANK_OUT_OF_RANGE);
+    expect_response(responses[9], BinaryStatus::OK, 2);
+}
+
+TEST(BinaryProtocolTest, RejectsInvalidRecords) {
+    std::string input;
+    add_record(input, 'x', 1);
+    add_record(input, 'k', std::int64_t{INT_MAX} + 1);
+    add_record(input, 'n', std::int64_t{INT_MIN} - 1);
+    add_record(input, 'k', INT_MIN);
+
+    const auto responses = run_binary(input);
+    ASSERT_EQ(4, responses.size());
+    expect_response(responses[0], BinaryStatus::UNKNOWN_QUERY);
+    expect_response(responses[1], BinaryStatus::INVALID_ARGUMENT);
+    expect_response(responses[2], BinaryStatus::INVALID_ARGUMENT);
+    expect_response(responses[3], BinaryStatus::OK);
+}
+
+TEST(BinaryProtocolTest, TruncatedRecordIsAnError) {
+    std::string input;
+    add_record(input, 'k', 1);
+    input.append("n\0\0", 3);
+
+    const auto responses = run_binary(input, 1);
+    ASSERT_EQ(1, responses.size());
+    expect_response(responses[0], BinaryStatus::OK);
+}
+
+TEST(BinaryProtocolTest, ManyBlocks) {
+    std::string input;
+    const int n = 10'000;
+    for (int key = 0; key < n; key++)
+        add_record(input, 'k', key);
+    for (int k = 1; k <= n; k++)
+        add_record(input, 'm', k);
+
+    const auto responses = run_binary(input);
+    ASSERT_EQ(2 * n, responses.size());
+    for (int k = 1; k <= n; k++)
+        expect_response(responses[n + k - 1], BinaryStatus::OK, k - 1);
+}
+
+TEST(BinaryProtocolTest, ParseBinaryOption) {
+    const char *args[] = {"cli", "--binary", "--engine=b-plus-tree"};
+    const auto options = parse_cli_options(3, args);
+    EXPECT_TRUE(options.binary);
+    EXPECT_EQ(StorageEngine::B_PLUS_TREE, options.engine);
+    EXPECT_FALSE(parse_cli_options(1, args).binary);
+}
+
+TEST(BinaryProtocolTest, UnsupportedQuery) {
+    KeyStorage storage(StorageEngine::KLL_SKETCH);
+    expect_response(execute_binary_query(storage, BinaryRecord{'k', 5}), BinaryStatus::OK);
+    expect_response(execute_binary_query(storage, BinaryRecord{'d', 5}), BinaryStatus::UNSUPPORTED_QUERY);
+    expect_response(execute_binary_query(storage, BinaryRecord{'m', 1}), BinaryStatus::OK, 5);
+}
@@ -1,12 +1,22 @@
 #include <gtest/gtest.h>
+#include <filesystem>
 #include <sstream>
+#include <unistd.h>
+
+#include "CliOptions.h"
 
 extern int run();
 
+extern int run(const CliOptions &options);
+
 static void add_insert_query(std::stringstream &stream, int key) {
     stream << "k " << key << "\n";
 }
 
+static void add_erase_query(std::stringstream &stream, int key) {
+    stream << "d " << key << "\n";
+}
+
 static void add_invalid_find_order_statistic_query(std::stringstream &stream) {
     stream << "m " << "asdf" << "\n";
 }
@@ -38,12 +48,13 @@ static void add_find_order_statistic_queries(std::stringstream &stream, const st
     }
 }
 
-static void run_with_stream(const std::stringstream &input, std::stringstream &output) {
+static void run_with_stream(const std::stringstream &input, std::stringstream &output,
+                            const CliOptions &options = CliOptions()) {
     const auto old_input = std::cin.rdbuf();
     const auto old_output = std::cout.rdbuf();
     std::cin.rdbuf(input.rdbuf());
     std::cout.rdbuf(output.rdbuf());
-    EXPECT_EQ(0, run());
+    EXPECT_EQ(0, run(options));
     std::cin.rdbuf(old_input);
     std::cout.rdbuf(old_output);
 }
@@ -164,3 +175,169 @@ TEST(CliTest, InsertExistedValue) {
     expect_msg(output, "Successfully added.");
     expect_msg(output, "The key already exists. Try something different.");
 }
+
+
+TEST(CliTest, BPlusTreeEngine) {
+    std::stringstream input;
+    std::stringstream output;
+
+    auto keys = generate_serial_keys(static_cast<int>(10e3));
+    add_insert_queries(input, keys);
+    add_insert_queries(input, {1});
+    add_find_order_statistic_queries(input, keys);
+    add_lower_count_queries(input, keys);
+
+    run_with_stream(input, output, CliOptions{.engine = StorageEngine::B_PLUS_TREE});
+    skip_n_lines(output, keys.size());
+    expect_msg(output, "The key already exists. Try something different.");
+    expect_values<int>(output, keys);
+    std::vector<std::size_t> expected(keys.size());
+    std::transform(keys.begin(), keys.end(), expected.begin(), [](auto i) { return i - 1; });
+    expect_values<std::size_t>(output, expected);
+}
+
+TEST(CliTest, ParseEngineOption) {
+    const char *args[] = {"cli", "--engine=b-plus-tree"};
+    EXPECT_EQ(StorageEngine::B_PLUS_TREE, parse_cli_options(2, args).engine);
+    EXPECT_EQ(StorageEngine::RED_BLACK_TREE, parse_cli_options(1, args).engine);
+
+    const char *invalid_args[] = {"cli", "--engine=list"};
+    EXPECT_THROW(parse_cli_options(2, invalid_args), std::invalid_argument);
+}
+
+TEST(CliTest, MultisetEngine) {
+    std::stringstream input;
+    std::stringstream output;
+
+    add_insert_queries(input, {5, 5, 5, 7});
+    add_erase_query(input, 5);
+    add_erase_query(input, 6);
+    add_lower_count_query(input, 7);
+    add_find_order_statistic_query(input, 3);
+
+    run_with_stream(input, output, CliOptions{.engine = StorageEngine::RED_BLACK_MULTISET});
+    for (int i = 0; i < 4; i++)
+        expect_msg(output, "Successfully added.");
+    expect_msg(output, "Successfully deleted.");
+    expect_msg(output, "The key doesn't exist.");
+    expect_values<std::size_t>(output, std::vector<std::size_t>{2});
+    expect_values<int>(output, std::vector<int>{7});
+
+    const char *args[] = {"cli", "--engine=rb-multiset"};
+    EXPECT_EQ(StorageEngine::RED_BLACK_MULTISET, parse_cli_options(2, args).engine);
+}
+
+TEST(CliTest, KllEngine) {
+    std::stringstream input;
+    std::stringstream output;
+
+    // The sketch is exact until its first compaction, after 4K keys.
+    auto keys = generate_serial_keys(1000);
+    add_insert_queries(input, keys);
+    add_insert_query(input, 1);
+    add_erase_query(input, 1);
+    add_find_order_statistic_query(input, 500);
+    add_lower_count_query(input, 501);
+
+    run_with_stream(input, output, CliOptions{.engine = StorageEngine::KLL_SKETCH});
+    skip_n_lines(output, keys.size());
+    expect_msg(output, "Successfully added.");
+    expect_msg(output, "The storage engine doesn't support this query.");
+    expect_values<int>(output, std::vector<int>{499});
+    expect_values<std::size_t>(output, std::vector<std::size_t>{501});
+
+    const char *args[] = {"cli", "--engine=kll"};
+    EXPECT_EQ(StorageEngine::KLL_SKETCH, parse_cli_options(2, args).engine);
+    const char *snapshot_args[] = {"cli", "--engine=kll", "--snapshot=keys.snapshot"};
+    EXPECT_THROW(parse_cli_options(3, snapshot_args), std::invalid_argument);
+    const char *wal_args[] = {"cli", "--engine=kll", "--wal=log"};
+    EXPECT_THROW(parse_cli_options(3, wal_args), std::invalid_argument);
+    KeyStorage storage(StorageEngine::KLL_SKETCH);
+    EXPECT_THROW(storage.save(std::filesystem::temp_directory_path() / "kll.snapshot"), std::logic_error);
+    DurabilityOptions durability;
+    durability.directory = std::filesystem::temp_directory_path() / "kll_wal";
+    EXPECT_THROW(KeyStorage(StorageEngine::KLL_SKETCH, durability), std::logic_error);
+    EXPECT_FALSE(std::filesystem::exists(durability.directory));
+}
+
+TEST(CliTest, EraseKeys) {
+    for (const auto engine: {StorageEngine::RED_BLACK_TREE, StorageEngine::B_PLUS_TREE}) {
+        std::stringstream input;
+        std::stringstream output;
+
+        auto keys = generate_serial_keys(100);
+        add_insert_queries(input, keys);
+        for (int key = 1; key <= 50; key++)
+            add_erase_query(input, key);
+        add_erase_query(input, 1);
+        add_find_order_statistic_query(input, 1);
+        add_lower_count_query(input, 100);
+
+        run_with_stream(input, output, CliOptions{.engine = engine});
+        skip_n_lines(output, keys.size());
+        for (int key = 1; key <= 50; key++)
+            expect_msg(output, "Successfully deleted.");
+        expect_msg(output, "The key doesn't exist.");
+        expect_values<int>(output, std::vector<int>{51});
+        expect_values<std::size_t>(output, std::vector<std::size_t>{49});
+    }
+}
+
+TEST(CliTest, ArgumentsParsedLikeStream) {
+    std::stringstream input;
+    std::stringstream output;
+
+    input << "k +5\n" << "\tk   7abc  extra\n" << "k 99999999999\n" << "k\n" << "k +-1\n"
+          << "m -1\n" << "\n" << "n 6";
+
+    run_with_stream(input, output);
+    expect_msg(output, "Successfully added.");
+    expect_msg(output, "Successfully added.");
+    expect_msg(output, "Expected integer argument.");
+    expect_msg(output, "Expected integer argument.");
+    expect_msg(output, "Expected integer argument.");
+    expect_msg(output, "The key number must be greater than zero, "
+                       "but not greater than the storage size.");
+    expect_msg(output, "Unknown query.");
+    expect_msg(output, "1");
+}
+
+TEST(CliTest, SnapshotOption) {
+    const auto path = std::filesystem::temp_directory_path() /
+                      ("cli_snapshot_test_" + std::to_string(::getpid()) + ".snapshot");
+    std::filesystem::remove(path);
+    CliOptions options;
+    options.snapshot_path = path.string();
+    {
+        std::stringstream input;
+        std::stringstream output;
+        add_insert_queries(input, {30, 10, 20});
+        run_with_stream(input, output, options);
+    }
+    {
+        std::stringstream input;
+        std::stringstream output;
+        add_insert_query(input, 20);
+        add_find_order_statistic_query(input, 3);
+        add_lower_count_query(input, 25);
+        run_with_stream(input, output, options);
+        expect_msg(output, "The key already exists. Try something different.");
+        expect_values<int>(output, std::vector<int>{30});
+        expect_values<std::size_t>(output, std::vector<std::size_t>{2});
+    }
+
+    KeyStorage storage(StorageEngine::B_PLUS_TREE);
+    storage.load(path);
+    EXPECT_EQ(20, storage.find_order_statistic(2));
+    KeyStorage multiset(StorageEngine::RED_BLACK_MULTISET);
+    multiset.load(path);
+    multiset.insert_key(20);
+    multiset.save(path);
+    EXPECT_THROW(storage.load(path), std::invalid_argument);
+    std::filesystem::remove(path);
+
+    const char *args[] = {"cli", "--snapshot=keys.snapshot"};
+    EXPECT_EQ("keys.snapshot", parse_cli_options(2, args).snapshot_path);
+    const char *empty_path_args[] = {"cli", "--snapshot="};
+    EXPECT_THROW(parse_cli_options(2, empty_path_args), std::invalid_argument);
+}
@@ -0,0 +1,32 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "LineReader.h"
+
+static std::vector<std::string> read_lines(const std::string &text, bool line_mode, std::size_t block_size) {
+    std::istringstream input(text);
+    LineReader reader(input, line_mode, block_size);
+    std::vector<std::string> lines;
+    std::string_view line;
+    while (reader.next_line(line))
+        lines.emplace_back(line);
+    return lines;
+}
+
+TEST(LineReaderTest, SplitsLinesLikeGetline) {
+    const std::string long_line(1000, 'x');
+    const std::vector<std::string> texts = {"", "\n", "k 1\nk 2\n", "k 1\n\nn 2", "m 1\n" + long_line + "\nd 3\n"};
+    for (const auto &text: texts) {
+        std::istringstream input(text);
+        std::vector<std::string> expected;
+        std::string line;
+        while (std::getline(input, line))
+            expected.push_back(line);
+        for (const std::size_t block_size: {1, 3, 16, 1 << 20}) {
+            EXPECT_EQ(expected, read_lines(text, false, block_size));
+        }
+        EXPECT_EQ(expected, read_lines(text, true, 1));
+    }
+}
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <climits>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "ShardedKeyStorage.h"
+
+static void check_storage(ShardedKeyStorage &storage, const std::set<int> &expected) {
+    ASSERT_EQ(expected.size(), storage.size());
+    std::size_t i = 0;
+    for (const auto key: expected) {
+        ASSERT_EQ(i, storage.get_less_count(key));
+        ASSERT_EQ(key, storage.find_order_statistic(++i));
+    }
+}
+
+TEST(ShardedKeyStorageTest, RandomQueries) {
+    ShardedKeyStorage storage(8);
+    std::mt19937 engine(42);
+    std::uniform_int_distribution<int> uniform_dist(INT_MIN, INT_MAX);
+    std::set<int> expected;
+    for (int i = 0; i < 5000; i++) {
+        const auto key = uniform_dist(engine);
+        storage.insert_key(key);
+        expected.insert(key);
+    }
+    for (auto it = expected.begin(); it != expected.end();) {
+        storage.erase_key(*it);
+        it = expected.erase(it);
+        if (it != expected.end())
+            ++it;
+    }
+    check_storage(storage, expected);
+    EXPECT_EQ(0, storage.get_less_count(INT_MIN));
+    EXPECT_EQ(expected.size(), storage.get_less_count(INT_MAX));
+}
+
+TEST(ShardedKeyStorageTest, Errors) {
+    ShardedKeyStorage storage(4);
+    storage.insert_key(1);
+    EXPECT_THROW(storage.insert_key(1), std::invalid_argument);
+    EXPECT_THROW(storage.erase_key(2), std::invalid_argument);
+    EXPECT_THROW((void) storage.find_order_statistic(0), std::invalid_argument);
+    EXPECT_THROW((void) storage.find_order_statistic(2), std::invalid_argument);
+    EXPECT_THROW(ShardedKeyStorage(0), std::invalid_argument);
+}
+
+TEST(ShardedKeyStorageTest, SkewedKeysAreRebalanced) {
+    // Small sequential keys all fall into one shard of the initial int range split.
+    ShardedKeyStorage storage(8);
+    std::set<int> expected;
+    for (int key = 0; key < 20000; key++) {
+        storage.insert_key(key);
+        expected.insert(key);
+    }
+    EXPECT_GT(storage.rebalance_count(), 0);
+    const auto sizes = storage.shard_sizes();
+    const auto largest = *std::max_element(sizes.begin(), sizes.end());
+    EXPECT_LT(largest, 20000 / 2);
+    check_storage(storage, expected);
+}
+
+TEST(ShardedKeyStorageTest, ConcurrentInserts) {
+    constexpr int THREADS = 4;
+    constexpr int KEYS_PER_THREAD = 5000;
+    ShardedKeyStorage storage(8);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; t++) {
+        threads.emplace_back([&storage, t] {
+            for (int i = 0; i < KEYS_PER_THREAD; i++) {
+                storage.insert_key(i * THREADS + t);
+                if (i % 16 == 0)
+                    (void) storage.get_less_count(i);
+            }
+        });
+    }
+    for (auto &thread: threads)
+        thread.join();
+
+    std::set<int> expected;
+    for (int key = 0; key < THREADS * KEYS_PER_THREAD; key++)
+        expected.insert(key);
+    check_storage(storage, expected);
+}
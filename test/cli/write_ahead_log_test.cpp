@@ -0,0 +1,236 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <unistd.h>
+
+#include "BinaryProtocol.h"
+#include "CliOptions.h"
+#include "KeyStorage.h"
+#include "QueryExecutor.h"
+#include "WriteAheadLog.h"
+
+class WriteAheadLogTestSuite : public testing::Test {
+protected:
+    std::filesystem::path directory = std::filesystem::temp_directory_path() /
+                                      ("write_ahead_log_test_" + std::to_string(::getpid()));
+
+    void SetUp() override {
+        std::filesystem::remove_all(directory);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(directory);
+    }
+
+    [[nodiscard]] DurabilityOptions options(std::size_t sync_every = 1) const {
+        DurabilityOptions durability;
+        durability.directory = directory;
+        durability.sync_every = sync_every;
+        durability.checkpoint_interval = std::chrono::milliseconds(0);
+        return durability;
+    }
+
+    [[nodiscard]] std::size_t count_files(std::string_view prefix) const {
+        std::size_t count = 0;
+        for (const auto &entry: std::filesystem::directory_iterator(directory)) {
+            if (entry.path().filename().string().starts_with(prefix))
+                count++;
+        }
+        return count;
+    }
+
+    static std::vector<int> keys_of(KeyStorage &storage, std::size_t n) {
+        std::vector<int> keys;
+        for (std::size_t k = 1; k <= n; k++)
+            keys.push_back(storage.find_order_statistic(k));
+        return keys;
+    }
+};
+
+TEST_F(WriteAheadLogTestSuite, RecoversFromLog) {
+    {
+        KeyStorage storage(StorageEngine::RED_BLACK_TREE, options());
+        for (int key = 0; key < 100; key++)
+            storage.insert_key(key);
+        for (int key = 0; key < 100; key += 2)
+            storage.erase_key(key);
+        EXPECT_EQ(StorageStatus::KEY_EXISTS, storage.try_insert_key(1));
+    }
+    KeyStorage storage(StorageEngine::B_PLUS_TREE, options());
+    EXPECT_EQ(50, storage.get_less_count(100));
+    EXPECT_EQ(1, storage.find_order_statistic(1));
+    EXPECT_EQ(99, storage.find_order_statistic(50));
+    int key;
+    EXPECT_EQ(StorageStatus::RANK_OUT_OF_RANGE, storage.try_find_order_statistic(51, key));
+}
+
+TEST_F(WriteAheadLogTestSuite, CheckpointReplacesLog) {
+    {
+        KeyStorage storage(StorageEngine::RED_BLACK_TREE, options(16));
+        for (int key = 0; key < 1000; key++)
+            storage.insert_key(key);
+        storage.write_ahead_log()->checkpoint();
+        EXPECT_EQ(1, storage.write_ahead_log()->checkpoint_count());
+        EXPECT_EQ(1, count_files("checkpoint-"));
+        EXPECT_EQ(1, count_files("wal-"));
+        for (int key = 0; key < 500; key++)
+            storage.erase_key(key);
+        storage.insert_key(-1);
+        storage.write_ahead_log()->checkpoint();
+        storage.insert_key(-2);
+        storage.write_ahead_log()->checkpoint();
+        EXPECT_EQ(1, count_files("checkpoint-"));
+    }
+    const auto recovered = WriteAheadLog::recover(directory);
+    EXPECT_EQ(502, recovered.checkpoint_keys.size());
+    EXPECT_TRUE(recovered.tail.empty());
+
+    KeyStorage storage(StorageEngine::RED_BLACK_TREE, options());
+    EXPECT_EQ(502, storage.get_less_count(1000));
+    EXPECT_EQ(-2, storage.find_order_statistic(1));
+    EXPECT_EQ(500, storage.find_order_statistic(3));
+}
+
+TEST_F(WriteAheadLogTestSuite, CheckpointMergesSegmentsOfPreviousRun) {
+    {
+        KeyStorage storage(StorageEngine::RED_BLACK_MULTISET, options(0));
+        for (int i = 0; i < 10; i++)
+            storage.insert_key(7);
+        storage.write_ahead_log()->checkpoint();
+        storage.erase_key(7);
+        storage.insert_key(3);
+    }
+    {
+        KeyStorage storage(StorageEngine::RED_BLACK_MULTISET, options(0));
+        storage.write_ahead_log()->checkpoint();
+        EXPECT_EQ(1, storage.write_ahead_log()->checkpoint_count());
+    }
+    const auto recovered = WriteAheadLog::recover(directory);
+    EXPECT_TRUE(recovered.tail.empty());
+    std::vector<int> expected(10, 7);
+    expected[0] = 3;
+    EXPECT_EQ(expected, recovered.checkpoint_keys);
+}
+
+TEST_F(WriteAheadLogTestSuite, IgnoresTornRecords) {
+    {
+        KeyStorage storage(StorageEngine::RED_BLACK_TREE, options());
+        for (int key = 1; key <= 3; key++)
+            storage.insert_key(key);
+    }
+    const auto first_segment = directory / "wal-00000000000000000001.log";
+    std::filesystem::resize_file(first_segment, std::filesystem::file_size(first_segment) - 3);
+    {
+        KeyStorage storage(StorageEngine::RED_BLACK_TREE, options());
+        EXPECT_EQ((std::vector<int>{1, 2}), keys_of(storage, 2));
+        int key;
+        EXPECT_EQ(StorageStatus::RANK_OUT_OF_RANGE, storage.try_find_order_statistic(3, key));
+        storage.insert_key(5);
+    }
+    {
+        std::ofstream garbage(directory / "wal-00000000000000000002.log", std::ios::binary | std::ios::app);
+        garbage << "garbage!";
+    }
+    KeyStorage storage(StorageEngine::RED_BLACK_TREE, options());
+    EXPECT_EQ((std::vector<int>{1, 2, 5}), keys_of(storage, 3));
+}
+
+TEST_F(WriteAheadLogTestSuite, SkipsIncompleteCheckpoint) {
+    {
+        KeyStorage storage(StorageEngine::RED_BLACK_TREE, options());
+        storage.insert_key(1);
+        storage.write_ahead_log()->checkpoint();
+        storage.insert_key(2);
+    }
+    // A checkpoint torn by a crash before it was synced, its segments are still in the directory.
+    std::ofstream(directory / "checkpoint-00000000000000000099.snapshot") << "torn";
+    KeyStorage storage(StorageEngine::RED_BLACK_TREE, options());
+    EXPECT_EQ((std::vector<int>{1, 2}), keys_of(storage, 2));
+    storage.insert_key(3);
+    storage.write_ahead_log()->checkpoint();
+    EXPECT_EQ(1, count_files("checkpoint-"));
+    EXPECT_EQ((std::vector<int>{1, 2, 3}), WriteAheadLog::recover(directory).checkpoint_keys);
+}
+
+TEST_F(WriteAheadLogTestSuite, SkipsCorruptedCheckpoint) {
+    {
+        KeyStorage storage(StorageEngine::RED_BLACK_TREE, options());
+        for (int key = 1; key <= 100; key++)
+            storage.insert_key(key);
+        storage.write_ahead_log()->checkpoint();
+        storage.insert_key(101);
+    }
+    // A checkpoint of the right size whose contents didn't reach the disk.
+    std::filesystem::path checkpoint;
+    for (const auto &entry: std::filesystem::directory_iterator(directory)) {
+        if (entry.path().filename().string().starts_with("checkpoint-"))
+            checkpoint = entry.path();
+    }
+    const auto corrupted = directory / "checkpoint-00000000000000000099.snapshot";
+    std::filesystem::copy_file(checkpoint, corrupted);
+    {
+        std::fstream file(corrupted, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(static_cast<std::streamoff>(std::filesystem::file_size(corrupted) / 2));
+        file.put('\x7f');
+    }
+    const auto recovered = WriteAheadLog::recover(directory);
+    EXPECT_EQ(100, recovered.checkpoint_keys.size());
+    EXPECT_EQ(1, recovered.tail.size());
+    KeyStorage storage(StorageEngine::RED_BLACK_TREE, options());
+    EXPECT_EQ(101, storage.find_order_statistic(101));
+    EXPECT_FALSE(std::filesystem::exists(corrupted));
+}
+
+TEST_F(WriteAheadLogTestSuite, FailedLogWriteRollsBackChange) {
+    if (!std::filesystem::exists("/dev/full"))
+        GTEST_SKIP() << "/dev/full is needed to fail the log writes";
+    KeyStorage storage(StorageEngine::RED_BLACK_TREE, options());
+    storage.insert_key(1);
+    storage.insert_key(2);
+    // The checkpoint opens the next segment, every write to it fails as on a full disk.
+    std::filesystem::create_symlink("/dev/full", directory / "wal-00000000000000000002.log");
+    storage.write_ahead_log()->checkpoint();
+
+    EXPECT_EQ(StorageStatus::LOG_WRITE_FAILED, storage.try_insert_key(3));
+    EXPECT_EQ(StorageStatus::LOG_WRITE_FAILED, storage.try_erase_key(1));
+    EXPECT_EQ(StorageStatus::KEY_NOT_FOUND, storage.try_erase_key(3));
+    EXPECT_EQ(2, storage.get_less_count(3));
+    EXPECT_EQ((std::vector<int>{1, 2}), keys_of(storage, 2));
+
+    QueryExecutor executor(storage);
+    EXPECT_EQ(status_message(StorageStatus::LOG_WRITE_FAILED), executor.execute_query("k 4"));
+    const auto response = execute_binary_query(storage, BinaryRecord{'d', 2});
+    EXPECT_EQ(static_cast<std::uint8_t>(BinaryStatus::LOG_WRITE_FAILED), response.code);
+    EXPECT_EQ(2, storage.get_less_count(5));
+}
+
+TEST_F(WriteAheadLogTestSuite, BackgroundCheckpoints) {
+    auto durability = options(0);
+    durability.checkpoint_interval = std::chrono::milliseconds(5);
+    KeyStorage storage(StorageEngine::RED_BLACK_TREE, durability);
+    storage.insert_key(42);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (storage.write_ahead_log()->checkpoint_count() == 0 && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    EXPECT_GE(storage.write_ahead_log()->checkpoint_count(), 1);
+}
+
+TEST_F(WriteAheadLogTestSuite, DurableStorageCantLoadSnapshot) {
+    KeyStorage storage(StorageEngine::RED_BLACK_TREE, options());
+    EXPECT_THROW(storage.load(directory / "keys.snapshot"), std::logic_error);
+}
+
+TEST_F(WriteAheadLogTestSuite, ParseWalOptions) {
+    const char *args[] = {"cli", "--wal=data", "--sync-every=64"};
+    const auto parsed = parse_cli_options(3, args);
+    EXPECT_EQ("data", parsed.wal_directory);
+    EXPECT_EQ(64, parsed.sync_every);
+    EXPECT_EQ(1, parse_cli_options(2, args).sync_every);
+
+    const char *invalid_count_args[] = {"cli", "--wal=data", "--sync-every=-1"};
+    EXPECT_THROW(parse_cli_options(3, invalid_count_args), std::invalid_argument);
+    const char *conflicting_args[] = {"cli", "--wal=data", "--snapshot=keys.snapshot"};
+    EXPECT_THROW(parse_cli_options(3, conflicting_args), std::invalid_argument);
+}
@@ -0,0 +1,197 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <set>
+
+#include "BPlusOrderStatisticTree.h"
+
+template<class Tree>
+class BPlusOrderStatisticTreeTestSuite : public testing::Test, public Tree {
+public:
+    using typename Tree::Node;
+    using typename Tree::LeafNode;
+    using typename Tree::InnerNode;
+
+    /**
+     * Checks separators, counts and leaf depth of the subtree and returns its key count.
+     */
+    std::size_t check_subtree(const Node *node, int depth, int &leaf_depth, long lower, long upper) {
+        if (node->is_leaf) {
+            if (leaf_depth < 0)
+                leaf_depth = depth;
+            EXPECT_EQ(leaf_depth, depth);
+            const auto leaf = static_cast<const LeafNode *>(node);
+            for (std::size_t i = 0; i < leaf->size; i++) {
+                EXPECT_LE(lower, leaf->keys[i]);
+                EXPECT_GT(upper, leaf->keys[i]);
+                if (i > 0) {
+                    EXPECT_LT(leaf->keys[i - 1], leaf->keys[i]);
+                }
+            }
+            return leaf->size;
+        }
+        const auto inner = static_cast<const InnerNode *>(node);
+        EXPECT_LE(2, inner->size);
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < inner->size; i++) {
+            const long child_lower = i == 0 ? lower : inner->keys[i - 1];
+            const long child_upper = i + 1 == inner->size ? upper : inner->keys[i];
+            const auto child_count = check_subtree(inner->children[i], depth + 1, leaf_depth,
+                                                   child_lower, child_upper);
+            EXPECT_EQ(child_count, inner->counts[i]);
+            total += child_count;
+        }
+        return total;
+    }
+
+    void check_tree() {
+        int leaf_depth = -1;
+        EXPECT_EQ(this->size(), check_subtree(this->root, 0, leaf_depth, INT_MIN, INT_MAX + 1L));
+    }
+};
+
+using TreeTypes = testing::Types<BPlusOrderStatisticTree<16>, BPlusOrderStatisticTree<64>>;
+TYPED_TEST_SUITE(BPlusOrderStatisticTreeTestSuite, TreeTypes);
+
+static std::vector<int> generate_shuffled_keys(int n) {
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), -n / 2);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+    return keys;
+}
+
+TYPED_TEST(BPlusOrderStatisticTreeTestSuite, InvariantsOnShuffledKeys) {
+    for (const auto key: generate_shuffled_keys(100000))
+        EXPECT_TRUE(this->insert(key).second);
+    this->check_tree();
+}
+
+TYPED_TEST(BPlusOrderStatisticTreeTestSuite, InvariantsOnSerialKeys) {
+    for (int key = 0; key < 100000; key++)
+        this->insert(key);
+    for (int key = -1; key > -100000; key--)
+        this->insert(key);
+    this->check_tree();
+}
+
+TYPED_TEST(BPlusOrderStatisticTreeTestSuite, InsertionNotUnique) {
+    const auto keys = generate_shuffled_keys(10000);
+    for (const auto key: keys)
+        this->insert(key);
+    for (const auto key: keys) {
+        EXPECT_TRUE(this->contains(key));
+        const auto [position, inserted] = this->insert(key);
+        EXPECT_FALSE(inserted);
+        EXPECT_EQ(key, *position);
+    }
+    EXPECT_EQ(keys.size(), this->size());
+    EXPECT_FALSE(this->contains(20000));
+}
+
+TYPED_TEST(BPlusOrderStatisticTreeTestSuite, RankQueries) {
+    std::mt19937 engine(7);
+    std::uniform_int_distribution<int> uniform_dist(INT_MIN, INT_MAX);
+    std::set<int> keys;
+    for (int i = 0; i < 50000; i++) {
+        const int key = uniform_dist(engine);
+        keys.insert(key);
+        this->insert(key);
+    }
+    std::size_t i = 0;
+    for (const auto key: keys) {
+        EXPECT_EQ(i, this->less_count(key));
+        EXPECT_EQ(key, this->find_order_statistic(i + 1));
+        i++;
+    }
+    EXPECT_EQ(keys.size(), this->less_count(INT_MAX) + (keys.count(INT_MAX) ? 1 : 0));
+    EXPECT_THROW((void) this->find_order_statistic(0), std::logic_error);
+    EXPECT_THROW((void) this->find_order_statistic(keys.size() + 1), std::logic_error);
+    this->clear();
+    EXPECT_THROW((void) this->find_order_statistic(0), std::logic_error);
+}
+
+TYPED_TEST(BPlusOrderStatisticTreeTestSuite, CopyAndClear) {
+    for (const auto key: generate_shuffled_keys(1000))
+        this->insert(key);
+    TypeParam copy(*static_cast<TypeParam *>(this));
+    this->clear();
+    EXPECT_TRUE(this->empty());
+    EXPECT_EQ(0, this->less_count(0));
+    EXPECT_EQ(1000, copy.size());
+    EXPECT_EQ(500, copy.less_count(0));
+    EXPECT_EQ(-500, copy.find_order_statistic(1));
+}
+
+TYPED_TEST(BPlusOrderStatisticTreeTestSuite, InsertReturnsPosition) {
+    for (const auto key: generate_shuffled_keys(10000)) {
+        const auto [position, inserted] = this->insert(key);
+        EXPECT_TRUE(inserted);
+        EXPECT_EQ(key, *position);
+        EXPECT_TRUE(position == this->find(key));
+    }
+}
+
+TYPED_TEST(BPlusOrderStatisticTreeTestSuite, Iteration) {
+    auto keys = generate_shuffled_keys(10000);
+    for (const auto key: keys)
+        this->insert(key);
+    std::sort(keys.begin(), keys.end());
+    EXPECT_TRUE(std::equal(keys.begin(), keys.end(), this->begin(), this->end()));
+
+    TypeParam copy(*static_cast<TypeParam *>(this));
+    EXPECT_TRUE(std::equal(keys.begin(), keys.end(), copy.begin(), copy.end()));
+    EXPECT_TRUE(copy.find(100000) == copy.end());
+}
+
+TYPED_TEST(BPlusOrderStatisticTreeTestSuite, EraseKeys) {
+    std::mt19937 engine(42);
+    std::uniform_int_distribution<int> uniform_dist(0, 20000);
+    std::set<int> expected;
+    for (int i = 0; i < 200000; i++) {
+        const int key = uniform_dist(engine);
+        if (i % 3 == 0) {
+            EXPECT_EQ(expected.erase(key), this->erase(key));
+        } else {
+            expected.insert(key);
+            this->insert(key);
+        }
+    }
+    this->check_tree();
+    EXPECT_EQ(expected.size(), this->size());
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), this->begin(), this->end()));
+    std::size_t i = 0;
+    for (const auto key: expected) {
+        EXPECT_EQ(i, this->less_count(key));
+        EXPECT_EQ(key, this->find_order_statistic(i + 1));
+        i++;
+    }
+}
+
+TYPED_TEST(BPlusOrderStatisticTreeTestSuite, EraseAllKeys) {
+    auto keys = generate_shuffled_keys(20000);
+    for (const auto key: keys)
+        this->insert(key);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        EXPECT_EQ(1, this->erase(keys[i]));
+        EXPECT_EQ(0, this->erase(keys[i]));
+        if (i % 1000 == 0)
+            this->check_tree();
+    }
+    EXPECT_TRUE(this->empty());
+    EXPECT_TRUE(this->begin() == this->end());
+    EXPECT_TRUE(this->insert(1).second);
+}
+
+TYPED_TEST(BPlusOrderStatisticTreeTestSuite, EraseKth) {
+    for (int key = 0; key < 1000; key++)
+        this->insert(key);
+    EXPECT_EQ(0, this->erase_kth(1));
+    EXPECT_EQ(999, this->erase_kth(this->size()));
+    EXPECT_EQ(500, this->erase_kth(500));
+    EXPECT_THROW(this->erase_kth(0), std::logic_error);
+    this->check_tree();
+    EXPECT_EQ(997, this->size());
+    EXPECT_EQ(499, this->less_count(501));
+}
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "BufferedOrderStatisticTree.h"
+#include "NodeArena.h"
+
+TEST(BufferedOrderStatisticTreeTest, QueriesSeeBufferedKeys) {
+    BufferedOrderStatisticTree<> tree;
+    for (const auto key: {5, 1, 9, 5, 3})
+        tree.insert(key);
+    EXPECT_EQ(5, tree.buffered_count());
+    EXPECT_TRUE(tree.main_tree().empty());
+    EXPECT_EQ(4, tree.size());
+    EXPECT_EQ(2, tree.less_count(4));
+    EXPECT_EQ(5, tree.find_order_statistic(3));
+    EXPECT_TRUE(tree.contains(9));
+    EXPECT_FALSE(tree.contains(4));
+    EXPECT_THROW((void) tree.find_order_statistic(5), std::logic_error);
+    EXPECT_THROW((void) tree.find_order_statistic(0), std::logic_error);
+
+    tree.flush();
+    EXPECT_EQ(0, tree.buffered_count());
+    EXPECT_EQ((std::vector<int>{1, 3, 5, 9}), tree.main_tree().sorted_keys());
+}
+
+TEST(BufferedOrderStatisticTreeTest, RunIsDisjointFromTree) {
+    BufferedOrderStatisticTree<> tree;
+    for (int key = 0; key < 100; key += 2)
+        tree.insert(key);
+    tree.flush();
+    for (int key = 0; key < 20; key++)
+        tree.insert(key);
+    EXPECT_EQ(60, tree.size());
+    EXPECT_EQ(10, tree.buffered_count());
+    EXPECT_EQ(15, tree.less_count(15));
+    for (std::size_t k = 1; k <= 20; k++)
+        EXPECT_EQ(static_cast<int>(k) - 1, tree.find_order_statistic(k));
+    EXPECT_EQ(20, tree.find_order_statistic(21));
+    EXPECT_EQ(98, tree.find_order_statistic(60));
+
+    EXPECT_EQ(1, tree.erase(7));
+    EXPECT_EQ(1, tree.erase(8));
+    EXPECT_EQ(0, tree.erase(9 + 100));
+    EXPECT_EQ(58, tree.size());
+    EXPECT_EQ(9, tree.find_order_statistic(8));
+
+    // A buffer shorter than the run goes into the tree, a longer one is merged into the run.
+    for (int key = 101; key < 106; key += 2)
+        tree.insert(key);
+    EXPECT_EQ(61, tree.size());
+    EXPECT_EQ(9, tree.buffered_count());
+    EXPECT_EQ(52, tree.main_tree().size());
+    for (int key = 201; key < 240; key += 2)
+        tree.insert(key);
+    EXPECT_EQ(81, tree.size());
+    EXPECT_EQ(29, tree.buffered_count());
+    EXPECT_EQ(52, tree.main_tree().size());
+}
+
+TEST(BufferedOrderStatisticTreeTest, MergesAtThreshold) {
+    BufferedOrderStatisticTree<> tree(16);
+    for (int key = 0; key < 15; key++)
+        tree.insert(key);
+    EXPECT_EQ(15, tree.buffered_count());
+    tree.insert(100);
+    EXPECT_EQ(0, tree.buffered_count());
+    EXPECT_EQ(16, tree.main_tree().size());
+
+    // The buffer grows with the tree.
+    for (int key = 200; key < 200 + 1000; key++)
+        tree.insert(key);
+    EXPECT_EQ(512, tree.main_tree().size());
+    EXPECT_EQ(504, tree.buffered_count());
+    EXPECT_EQ(1016, tree.size());
+}
+
+template<class Tree>
+static void compare_with_set(std::size_t min_merge_size) {
+    std::mt19937 engine(42);
+    std::uniform_int_distribution<int> key_dist(0, 2000);
+    std::uniform_int_distribution<int> operation_dist(0, 99);
+    BufferedOrderStatisticTree<Tree> tree(min_merge_size);
+    std::set<int> expected;
+    for (int i = 0; i < 20000; i++) {
+        const int key = key_dist(engine);
+        const int operation = operation_dist(engine);
+        if (operation < 70) {
+            tree.insert(key);
+            expected.insert(key);
+        } else if (operation < 80) {
+            ASSERT_EQ(expected.erase(key), tree.erase(key));
+        } else if (operation < 90) {
+            ASSERT_EQ(std::distance(expected.begin(), expected.lower_bound(key)), tree.less_count(key));
+        } else if (!expected.empty()) {
+            const auto k = static_cast<std::size_t>(key) % expected.size() + 1;
+            ASSERT_EQ(*std::next(expected.begin(), static_cast<std::ptrdiff_t>(k - 1)), tree.find_order_statistic(k));
+        }
+    }
+    EXPECT_EQ(std::vector<int>(expected.begin(), expected.end()), tree.sorted_keys());
+    tree.flush();
+    EXPECT_EQ(std::vector<int>(expected.begin(), expected.end()), tree.main_tree().sorted_keys());
+}
+
+TEST(BufferedOrderStatisticTreeTest, RandomOperations) {
+    compare_with_set<OrderStatisticTree>(16);
+    compare_with_set<OrderStatisticTree>(1 << 12);
+}
+
+TEST(BufferedOrderStatisticTreeTest, ArenaTree) {
+    compare_with_set<BasicOrderStatisticTree<int, std::less<int>, NoAugmentation, NodeArena<int>>>(64);
+}
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <set>
+
+#include "CompactOrderStatisticTree.h"
+
+class CompactOrderStatisticTreeTestSuite : public testing::Test, public CompactOrderStatisticTree {
+public:
+    /**
+     * Checks red-black and count invariants of the subtree and returns its black height.
+     */
+    int check_subtree(Index index) {
+        if (index == NIL)
+            return 1;
+        const auto &node = nodes[index];
+        if (node.count_and_color & RED_BIT) {
+            EXPECT_FALSE(nodes[node.left].count_and_color & RED_BIT);
+            EXPECT_FALSE(nodes[node.right].count_and_color & RED_BIT);
+        }
+        const auto count = [this](Index i) { return nodes[i].count_and_color & ~RED_BIT; };
+        EXPECT_EQ(count(node.left) + count(node.right) + 1, count(index));
+        const int left_height = check_subtree(node.left);
+        const int right_height = check_subtree(node.right);
+        EXPECT_EQ(left_height, right_height);
+        return left_height + ((node.count_and_color & RED_BIT) ? 0 : 1);
+    }
+};
+
+static std::vector<int> generate_shuffled_keys(int n) {
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), -n / 2);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+    return keys;
+}
+
+TEST_F(CompactOrderStatisticTreeTestSuite, NodeIs16Bytes) {
+    EXPECT_EQ(16, sizeof(Node));
+}
+
+TEST_F(CompactOrderStatisticTreeTestSuite, RedBlackInvariants) {
+    for (const auto key: generate_shuffled_keys(10000))
+        insert(key);
+    EXPECT_FALSE(nodes[root].count_and_color & RED_BIT);
+    check_subtree(root);
+}
+
+TEST_F(CompactOrderStatisticTreeTestSuite, SerialKeysInvariants) {
+    for (int key = 0; key < 10000; key++)
+        insert(key);
+    check_subtree(root);
+}
+
+TEST_F(CompactOrderStatisticTreeTestSuite, InsertionNotUnique) {
+    const auto keys = generate_shuffled_keys(1000);
+    for (const auto key: keys)
+        EXPECT_TRUE(insert(key));
+    for (const auto key: keys) {
+        EXPECT_TRUE(contains(key));
+        EXPECT_FALSE(insert(key));
+    }
+    EXPECT_EQ(keys.size(), size());
+    EXPECT_FALSE(contains(100000));
+}
+
+TEST_F(CompactOrderStatisticTreeTestSuite, RankQueries) {
+    std::mt19937 engine(7);
+    std::uniform_int_distribution<int> uniform_dist(INT_MIN, INT_MAX);
+    std::set<int> keys;
+    for (int i = 0; i < 10000; i++) {
+        const int key = uniform_dist(engine);
+        keys.insert(key);
+        insert(key);
+    }
+    std::size_t i = 0;
+    for (const auto key: keys) {
+        EXPECT_EQ(i, less_count(key));
+        EXPECT_EQ(key, find_order_statistic(i + 1));
+        i++;
+    }
+    EXPECT_EQ(0, less_count(INT_MIN));
+    EXPECT_EQ(keys.size(), size());
+}
+
+TEST_F(CompactOrderStatisticTreeTestSuite, Clear) {
+    for (const auto key: generate_shuffled_keys(100))
+        insert(key);
+    clear();
+    EXPECT_TRUE(empty());
+    EXPECT_EQ(0, less_count(0));
+    EXPECT_THROW((void) find_order_statistic(0), std::logic_error);
+    EXPECT_TRUE(insert(1));
+    EXPECT_EQ(1, find_order_statistic(1));
+    EXPECT_THROW((void) find_order_statistic(0), std::logic_error);
+    EXPECT_THROW((void) find_order_statistic(2), std::logic_error);
+}
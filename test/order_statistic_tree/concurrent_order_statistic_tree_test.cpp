@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "ConcurrentOrderStatisticTree.h"
+
+TEST(ConcurrentOrderStatisticTreeTest, SingleThread) {
+    ConcurrentOrderStatisticTree<> tree;
+    EXPECT_TRUE(tree.insert(5));
+    EXPECT_TRUE(tree.insert(1));
+    EXPECT_FALSE(tree.insert(5));
+    EXPECT_EQ(2, tree.insert_batch(std::vector<int>{3, 7, 1}));
+    EXPECT_EQ(4, tree.size());
+    EXPECT_EQ(2, tree.less_count(4));
+    EXPECT_EQ(5, tree.find_order_statistic(3));
+    EXPECT_EQ(1, tree.erase(3));
+    EXPECT_FALSE(tree.contains(3));
+    EXPECT_EQ(3, tree.size());
+    EXPECT_THROW((void) tree.find_order_statistic(4), std::logic_error);
+    EXPECT_EQ(3, tree.size());
+}
+
+/**
+ * The writer adds 0, 1, 2, ... in order, so every consistent state is a prefix of the keys.
+ */
+TEST(ConcurrentOrderStatisticTreeTest, ReadersSeeConsistentStates) {
+    constexpr int key_count = 20000;
+    ConcurrentOrderStatisticTree<> tree;
+    std::atomic<bool> done = false;
+    std::atomic<int> failures = 0;
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; i++) {
+        readers.emplace_back([&tree, &done, &failures] {
+            std::size_t last_size = 0;
+            while (!done.load()) {
+                const bool consistent = tree.read([&last_size](const OrderStatisticTree &snapshot) {
+                    const auto size = snapshot.size();
+                    const bool prefix = size == 0 || (
+                            snapshot.find_order_statistic(size) == static_cast<int>(size) - 1 &&
+                            snapshot.less_count(static_cast<int>(size)) == size);
+                    const bool monotonic = size >= last_size;
+                    last_size = size;
+                    return prefix && monotonic;
+                });
+                if (!consistent)
+                    failures++;
+                std::this_thread::yield();
+            }
+        });
+    }
+
+    constexpr int single_count = 1000;
+    for (int key = 0; key < single_count; key++)
+        tree.insert(key);
+    std::vector<int> batch;
+    for (int key = single_count; key < key_count; key++) {
+        batch.push_back(key);
+        if (batch.size() == 100) {
+            tree.insert_batch(batch);
+            batch.clear();
+        }
+    }
+    done = true;
+    for (auto &reader: readers)
+        reader.join();
+
+    EXPECT_EQ(0, failures.load());
+    EXPECT_EQ(key_count, tree.size());
+    EXPECT_EQ(key_count / 2, tree.less_count(key_count / 2));
+}
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include <climits>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "FrozenOrderStatisticTree.h"
+#include "OrderStatisticTree.h"
+
+/**
+ * Compares every query of the frozen copy of tree with the tree, including keys between and outside the tree keys.
+ */
+template<class Tree>
+static void check_frozen(const Tree &tree) {
+    const auto frozen = freeze(tree);
+    ASSERT_EQ(tree.size(), frozen.size());
+    EXPECT_EQ(tree.empty(), frozen.empty());
+    EXPECT_EQ(tree.sorted_keys(), frozen.sorted_keys());
+    for (std::size_t k = 1; k <= tree.size(); k++)
+        EXPECT_EQ(tree.find_order_statistic(k), frozen.find_order_statistic(k));
+    std::vector<int> queries = {INT_MIN, INT_MAX};
+    for (const auto key: tree) {
+        queries.push_back(key);
+        if (key != INT_MIN)
+            queries.push_back(key - 1);
+        if (key != INT_MAX)
+            queries.push_back(key + 1);
+    }
+    for (const auto key: queries) {
+        EXPECT_EQ(tree.less_count(key), frozen.less_count(key)) << key;
+        EXPECT_EQ(tree.contains(key), frozen.contains(key)) << key;
+    }
+    EXPECT_THROW((void) frozen.find_order_statistic(0), std::logic_error);
+    EXPECT_THROW((void) frozen.find_order_statistic(tree.size() + 1), std::logic_error);
+}
+
+TEST(FrozenOrderStatisticTreeTest, AllShapes) {
+    for (int n = 0; n <= 300; n++) {
+        OrderStatisticTree tree;
+        for (int key = 0; key < n; key++)
+            tree.insert(2 * key);
+        check_frozen(tree);
+    }
+}
+
+TEST(FrozenOrderStatisticTreeTest, RandomKeys) {
+    std::mt19937 engine(42);
+    std::uniform_int_distribution<int> uniform_dist(INT_MIN, INT_MAX);
+    OrderStatisticTree tree;
+    for (int i = 0; i < 100000; i++)
+        tree.insert(uniform_dist(engine));
+    tree.insert(INT_MIN);
+    tree.insert(INT_MAX);
+    check_frozen(tree);
+}
+
+TEST(FrozenOrderStatisticTreeTest, Multiset) {
+    std::mt19937 engine(42);
+    std::uniform_int_distribution<int> uniform_dist(0, 100);
+    OrderStatisticMultiset multiset;
+    for (int i = 0; i < 3000; i++)
+        multiset.insert(uniform_dist(engine));
+    check_frozen(multiset);
+}
+
+TEST(FrozenOrderStatisticTreeTest, CustomCompare) {
+    BasicOrderStatisticTree<int, std::greater<int>> tree;
+    for (int key = 0; key < 100; key++)
+        tree.insert(key);
+    const auto frozen = freeze(tree);
+    EXPECT_EQ(99, frozen.find_order_statistic(1));
+    EXPECT_EQ(10, frozen.less_count(89));
+    EXPECT_EQ(100, frozen.less_count(-1));
+    EXPECT_EQ(tree.sorted_keys(), frozen.sorted_keys());
+}
+
+TEST(FrozenOrderStatisticTreeTest, BatchQueries) {
+    const std::vector<int> keys = {1, 3, 5, 7, 9};
+    const auto frozen = FrozenOrderStatisticTree<>::build_from_sorted(keys);
+    const std::vector<int> queried_keys = {0, 4, 9, 10};
+    std::vector<std::size_t> counts(queried_keys.size());
+    frozen.less_count_batch(queried_keys, counts);
+    EXPECT_EQ((std::vector<std::size_t>{0, 2, 4, 5}), counts);
+    const std::vector<std::size_t> ranks = {5, 1, 3};
+    std::vector<int> found(ranks.size());
+    frozen.find_order_statistic_batch(ranks, found);
+    EXPECT_EQ((std::vector<int>{9, 1, 5}), found);
+    EXPECT_THROW(frozen.less_count_batch(queried_keys, std::span(counts).first(2)), std::invalid_argument);
+    EXPECT_TRUE(FrozenOrderStatisticTree<>().empty());
+    EXPECT_EQ(0, FrozenOrderStatisticTree<>().less_count(1));
+}
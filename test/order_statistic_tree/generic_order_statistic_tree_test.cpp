@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <set>
+
+#include "NodeArena.h"
+#include "OrderStatisticTree.h"
+
+using TimestampTree = BasicOrderStatisticTree<std::int64_t, std::less<>, SumAugmentation<std::int64_t>>;
+using DescendingTree = BasicOrderStatisticTree<double, std::greater<double>, MaxAugmentation<double>>;
+using SumMultiset = BasicOrderStatisticTree<int, std::less<int>, SumAugmentation<std::int64_t>,
+        std::allocator<int>, true>;
+
+/** Fixed-width prefix of a string, compared lexicographically. */
+using Prefix = std::array<char, 8>;
+
+static Prefix make_prefix(const std::string &value) {
+    Prefix prefix{};
+    std::copy_n(value.begin(), std::min(value.size(), prefix.size()), prefix.begin());
+    return prefix;
+}
+
+template<class Container>
+static std::int64_t sum_of_first(const Container &keys, std::size_t k) {
+    return std::accumulate(keys.begin(), std::next(keys.begin(), static_cast<std::ptrdiff_t>(k)), std::int64_t(0));
+}
+
+TEST(GenericOrderStatisticTreeTest, PrefixSumsOfTimestamps) {
+    std::mt19937_64 engine(42);
+    std::uniform_int_distribution<std::int64_t> uniform_dist(0, std::int64_t(1) << 40);
+    TimestampTree tree;
+    std::set<std::int64_t> expected;
+    for (int i = 0; i < 5000; i++) {
+        const auto key = uniform_dist(engine);
+        if (i % 4 == 0 && !expected.empty()) {
+            const auto k = static_cast<std::size_t>(key) % expected.size();
+            const auto erased = *std::next(expected.begin(), static_cast<std::ptrdiff_t>(k));
+            EXPECT_EQ(erased, tree.erase_kth(k + 1));
+            expected.erase(erased);
+        } else {
+            EXPECT_EQ(expected.insert(key).second, tree.insert(key).second);
+        }
+    }
+    EXPECT_EQ(sum_of_first(expected, expected.size()), tree.summary());
+    for (std::size_t k = 0; k <= expected.size(); k += 97)
+        EXPECT_EQ(sum_of_first(expected, k), tree.prefix_summary(k));
+    EXPECT_THROW((void) tree.prefix_summary(expected.size() + 1), std::logic_error);
+}
+
+TEST(GenericOrderStatisticTreeTest, CustomComparator) {
+    DescendingTree tree;
+    for (const double key: {0.5, -1.25, 3.0, 2.5})
+        tree.insert(key);
+    EXPECT_EQ(3.0, tree.find_order_statistic(1));
+    EXPECT_EQ(-1.25, tree.find_order_statistic(4));
+    EXPECT_EQ(1, tree.less_count(2.75));
+    EXPECT_EQ(3.0, tree.summary());
+    EXPECT_EQ(3.0, tree.prefix_summary(3));
+    EXPECT_EQ((std::vector<double>{3.0, 2.5, 0.5, -1.25}), tree.sorted_keys());
+
+    tree.erase(3.0);
+    EXPECT_EQ(2.5, tree.summary());
+    EXPECT_EQ(MaxAugmentation<double>::identity(), tree.prefix_summary(0));
+}
+
+TEST(GenericOrderStatisticTreeTest, StringPrefixKeys) {
+    BasicOrderStatisticTree<Prefix> tree;
+    for (const auto *value: {"latency", "cpu", "memory", "disk", "cpu"})
+        tree.insert(make_prefix(value));
+    EXPECT_EQ(4, tree.size());
+    EXPECT_EQ(make_prefix("disk"), tree.find_order_statistic(2));
+    EXPECT_EQ(2, tree.less_count(make_prefix("latency")));
+    EXPECT_TRUE(tree.contains(make_prefix("memory")));
+}
+
+TEST(GenericOrderStatisticTreeTest, MultisetPrefixSums) {
+    std::mt19937 engine(42);
+    std::uniform_int_distribution<int> uniform_dist(0, 100);
+    SumMultiset tree;
+    std::multiset<int> expected;
+    for (int i = 0; i < 5000; i++) {
+        const int key = uniform_dist(engine);
+        if (i % 3 == 0 && expected.contains(key)) {
+            tree.erase(tree.find(key));
+            expected.erase(expected.find(key));
+        } else {
+            tree.insert(key);
+            expected.insert(key);
+        }
+    }
+    for (std::size_t k = 0; k <= expected.size(); k += 31)
+        EXPECT_EQ(sum_of_first(expected, k), tree.prefix_summary(k));
+
+    std::vector<int> sorted(expected.begin(), expected.end());
+    const auto built = SumMultiset::build_from_sorted(sorted);
+    EXPECT_EQ(sum_of_first(sorted, sorted.size()), built.summary());
+    EXPECT_EQ(sum_of_first(sorted, sorted.size() / 2), built.prefix_summary(sorted.size() / 2));
+}
+
+/** Node layout of the int tree before the augmentation was added. */
+struct PlainNode {
+    int color;
+    int key;
+    std::size_t count;
+    void *left;
+    void *right;
+    void *parent;
+};
+
+struct NodeSize : OrderStatisticTree {
+    static constexpr std::size_t value = sizeof(Node);
+};
+
+TEST(GenericOrderStatisticTreeTest, NoAugmentationKeepsNodeSize) {
+    EXPECT_EQ(sizeof(PlainNode), NodeSize::value);
+}
+
+TEST(GenericOrderStatisticTreeTest, ArenaTreeJoinSplitAndUnite) {
+    using ArenaTree = BasicOrderStatisticTree<int, std::less<int>, NoAugmentation, NodeArena<int>>;
+    ArenaTree left;
+    ArenaTree right;
+    for (int key = 0; key < 100; key++) {
+        left.insert(key);
+        right.insert(key + 200);
+    }
+    auto tree = ArenaTree::join(std::move(left), 150, std::move(right));
+    EXPECT_EQ(201, tree.size());
+    EXPECT_EQ(100, tree.less_count(150));
+
+    auto greater = tree.split(150);
+    EXPECT_EQ(100, tree.size());
+    EXPECT_EQ(101, greater.size());
+    EXPECT_EQ(150, *greater.begin());
+
+    tree.unite(std::move(greater));
+    ArenaTree other;
+    for (int key = 50; key < 120; key++)
+        other.insert(key);
+    tree.unite(std::move(other));
+    EXPECT_EQ(221, tree.size());
+    EXPECT_EQ(120, tree.less_count(150));
+}
+
+TEST(GenericOrderStatisticTreeTest, UniteKeepsSummaries) {
+    TimestampTree tree;
+    TimestampTree other;
+    for (std::int64_t key = 0; key < 3000; key++)
+        (key % 3 == 0 ? tree : other).insert(key);
+    tree.unite(std::move(other));
+    for (std::size_t k = 0; k <= 3000; k += 250)
+        EXPECT_EQ(static_cast<std::int64_t>(k * (k - 1) / 2), tree.prefix_summary(k));
+    auto greater = tree.split(1000);
+    EXPECT_EQ(999 * 1000 / 2, tree.summary());
+    EXPECT_EQ(2999 * 3000 / 2 - 999 * 1000 / 2, greater.summary());
+}
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "KllSketch.h"
+
+static std::vector<int> random_keys(std::size_t n, std::uint32_t seed) {
+    std::mt19937 engine(seed);
+    std::uniform_int_distribution<int> uniform_dist(0, 1 << 30);
+    std::vector<int> keys(n);
+    for (auto &key: keys)
+        key = uniform_dist(engine);
+    return keys;
+}
+
+/**
+ * The largest rank error of less_count and find_order_statistic over 1000 evenly spaced ranks, as a fraction of n.
+ */
+template<class Sketch>
+static double max_rank_error(Sketch &sketch, std::vector<int> keys) {
+    std::sort(keys.begin(), keys.end());
+    const auto n = static_cast<double>(keys.size());
+    double max_error = 0;
+    for (std::size_t i = 1; i <= 1000; i++) {
+        const auto k = i * keys.size() / 1000;
+        const int key = keys[k - 1];
+        const auto exact = static_cast<double>(std::lower_bound(keys.begin(), keys.end(), key) - keys.begin());
+        max_error = std::max(max_error, std::abs(static_cast<double>(sketch.less_count(key)) - exact) / n);
+
+        const int found = sketch.find_order_statistic(k);
+        const auto found_first = std::lower_bound(keys.begin(), keys.end(), found) - keys.begin();
+        const auto found_last = std::upper_bound(keys.begin(), keys.end(), found) - keys.begin();
+        const auto rank = static_cast<std::ptrdiff_t>(k);
+        const auto distance = rank <= found_first ? found_first + 1 - rank : (rank > found_last ? rank - found_last : 0);
+        max_error = std::max(max_error, static_cast<double>(distance) / n);
+    }
+    return max_error;
+}
+
+TEST(KllSketchTest, ExactUntilFirstCompaction) {
+    KllSketch<> sketch;
+    for (const auto key: {5, 1, 9, 5, 3})
+        sketch.insert(key);
+    EXPECT_EQ(5, sketch.size());
+    EXPECT_EQ(5, sketch.retained_count());
+    EXPECT_EQ(2, sketch.less_count(4));
+    EXPECT_EQ(4, sketch.less_count(6));
+    EXPECT_EQ(1, sketch.find_order_statistic(1));
+    EXPECT_EQ(5, sketch.find_order_statistic(3));
+    EXPECT_EQ(5, sketch.find_order_statistic(4));
+    sketch.insert(0);
+    EXPECT_EQ(0, sketch.find_order_statistic(1));
+    EXPECT_THROW((void) sketch.find_order_statistic(7), std::logic_error);
+    EXPECT_THROW((void) sketch.find_order_statistic(0), std::logic_error);
+
+    sketch.clear();
+    EXPECT_TRUE(sketch.empty());
+    EXPECT_EQ(0, sketch.less_count(10));
+}
+
+TEST(KllSketchTest, RankErrorBound) {
+    for (std::uint32_t seed = 1; seed <= 3; seed++) {
+        const auto keys = random_keys(1'000'000, seed);
+        KllSketch<> sketch(KllSketch<>::DEFAULT_K, seed);
+        for (const auto key: keys)
+            sketch.insert(key);
+        EXPECT_LT(max_rank_error(sketch, keys), 0.001);
+    }
+}
+
+TEST(KllSketchTest, SortedAndRepeatedKeys) {
+    std::vector<int> keys(500'000);
+    std::iota(keys.begin(), keys.end(), 0);
+    KllSketch<> ascending;
+    for (const auto key: keys)
+        ascending.insert(key);
+    EXPECT_LT(max_rank_error(ascending, keys), 0.001);
+
+    for (auto &key: keys)
+        key %= 100;
+    KllSketch<> repeated;
+    for (const auto key: keys)
+        repeated.insert(key);
+    EXPECT_LT(max_rank_error(repeated, keys), 0.001);
+}
+
+TEST(KllSketchTest, MemoryIsBounded) {
+    KllSketch<> sketch(256);
+    std::size_t max_retained = 0;
+    for (const auto key: random_keys(2'000'000, 7)) {
+        sketch.insert(key);
+        max_retained = std::max(max_retained, sketch.retained_count());
+    }
+    EXPECT_EQ(2'000'000, sketch.size());
+    EXPECT_LT(max_retained, 3 * 256 + 64);
+}
+
+TEST(KllSketchTest, Merge) {
+    const auto keys = random_keys(1'000'000, 11);
+    const auto middle = keys.begin() + 300'000;
+    KllSketch<> left(KllSketch<>::DEFAULT_K, 1);
+    KllSketch<> right(KllSketch<>::DEFAULT_K, 2);
+    std::for_each(keys.begin(), middle, [&left](int key) { left.insert(key); });
+    std::for_each(middle, keys.end(), [&right](int key) { right.insert(key); });
+    left.merge(right);
+    EXPECT_EQ(keys.size(), left.size());
+    EXPECT_LT(left.retained_count(), 3 * KllSketch<>::DEFAULT_K + 64);
+    EXPECT_LT(max_rank_error(left, keys), 0.001);
+
+    EXPECT_THROW(left.merge(KllSketch<>(128)), std::invalid_argument);
+}
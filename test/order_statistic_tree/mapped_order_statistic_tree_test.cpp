@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include <climits>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <set>
+#include <system_error>
+#include <unistd.h>
+
+#include "MappedOrderStatisticTree.h"
+#include "OrderStatisticTree.h"
+#include "TreeSnapshot.h"
+
+class MappedOrderStatisticTreeTestSuite : public testing::Test {
+protected:
+    std::filesystem::path path = std::filesystem::temp_directory_path() /
+                                 ("mapped_tree_test_" + std::to_string(::getpid()) + ".snapshot");
+
+    void TearDown() override {
+        std::filesystem::remove(path);
+    }
+
+    /**
+     * Compares every query of the mapped snapshot of tree with the tree, including keys between
+     * and outside the tree keys.
+     */
+    template<class Tree>
+    void check_mapped(const Tree &tree) {
+        save_tree_snapshot(tree, path);
+        const MappedOrderStatisticTree<> mapped(path);
+        ASSERT_EQ(tree.size(), mapped.size());
+        EXPECT_EQ(tree.sorted_keys(), std::vector<int>(mapped.sorted_keys().begin(), mapped.sorted_keys().end()));
+        for (std::size_t k = 1; k <= tree.size(); k++)
+            EXPECT_EQ(tree.find_order_statistic(k), mapped.find_order_statistic(k));
+        std::vector<int> queries = {INT_MIN, INT_MAX};
+        for (const auto key: tree) {
+            queries.push_back(key);
+            if (key != INT_MIN)
+                queries.push_back(key - 1);
+            if (key != INT_MAX)
+                queries.push_back(key + 1);
+        }
+        for (const auto key: queries) {
+            EXPECT_EQ(tree.less_count(key), mapped.less_count(key)) << key;
+            EXPECT_EQ(tree.contains(key), mapped.contains(key)) << key;
+        }
+        EXPECT_THROW((void) mapped.find_order_statistic(0), std::logic_error);
+        EXPECT_THROW((void) mapped.find_order_statistic(tree.size() + 1), std::logic_error);
+    }
+};
+
+TEST_F(MappedOrderStatisticTreeTestSuite, SaveAndLoad) {
+    std::mt19937 engine(42);
+    std::uniform_int_distribution<int> uniform_dist(INT_MIN, INT_MAX);
+    OrderStatisticTree tree;
+    for (int i = 0; i < 50000; i++)
+        tree.insert(uniform_dist(engine));
+    save_tree_snapshot(tree, path);
+    EXPECT_EQ(tree.sorted_keys(), load_tree_snapshot<OrderStatisticTree>(path).sorted_keys());
+
+    tree.clear();
+    save_tree_snapshot(tree, path);
+    EXPECT_TRUE(load_tree_snapshot<OrderStatisticTree>(path).empty());
+}
+
+TEST_F(MappedOrderStatisticTreeTestSuite, QueriesMatchTree) {
+    for (const int n: {0, 1, 2, 15, 16, 17, 31, 32, 33, 255, 256, 1000, 4097}) {
+        OrderStatisticTree tree;
+        for (int key = 0; key < n; key++)
+            tree.insert(3 * key - n);
+        check_mapped(tree);
+    }
+    std::mt19937 engine(42);
+    std::uniform_int_distribution<int> uniform_dist(INT_MIN, INT_MAX);
+    OrderStatisticTree tree;
+    for (int i = 0; i < 100000; i++)
+        tree.insert(uniform_dist(engine));
+    tree.insert(INT_MIN);
+    tree.insert(INT_MAX);
+    check_mapped(tree);
+}
+
+TEST_F(MappedOrderStatisticTreeTestSuite, MultisetSnapshot) {
+    std::mt19937 engine(42);
+    std::uniform_int_distribution<int> uniform_dist(0, 300);
+    OrderStatisticMultiset multiset;
+    for (int i = 0; i < 5000; i++)
+        multiset.insert(uniform_dist(engine));
+    check_mapped(multiset);
+    EXPECT_EQ(multiset.sorted_keys(), load_tree_snapshot<OrderStatisticMultiset>(path).sorted_keys());
+    EXPECT_THROW(load_tree_snapshot<OrderStatisticTree>(path), std::invalid_argument);
+}
+
+TEST_F(MappedOrderStatisticTreeTestSuite, RejectsInvalidFiles) {
+    EXPECT_THROW(MappedOrderStatisticTree<>{path}, std::system_error);
+    EXPECT_THROW(load_tree_snapshot<OrderStatisticTree>(path), std::runtime_error);
+
+    {
+        std::ofstream output(path, std::ios::binary);
+        output << "k 1\nk 2\nm 1\nn 2\nd 1\nd 2\nk 3\nk 4\n";
+    }
+    EXPECT_THROW(MappedOrderStatisticTree<>{path}, std::runtime_error);
+    EXPECT_THROW(load_tree_snapshot<OrderStatisticTree>(path), std::runtime_error);
+
+    OrderStatisticTree tree;
+    for (int key = 0; key < 1000; key++)
+        tree.insert(key);
+    save_tree_snapshot(tree, path);
+    EXPECT_THROW(MappedOrderStatisticTree<long long>{path}, std::runtime_error);
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(static_cast<std::streamoff>(std::filesystem::file_size(path) / 2));
+        file.put('\x7f');
+    }
+    EXPECT_THROW(load_tree_snapshot<OrderStatisticTree>(path), std::runtime_error);
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 4);
+    EXPECT_THROW(MappedOrderStatisticTree<>{path}, std::runtime_error);
+    EXPECT_THROW(load_tree_snapshot<OrderStatisticTree>(path), std::runtime_error);
+}
+
+TEST_F(MappedOrderStatisticTreeTestSuite, FailedSaveLeavesPreviousSnapshot) {
+    OrderStatisticTree tree;
+    for (int key = 0; key < 100; key++)
+        tree.insert(key);
+    save_tree_snapshot(tree, path);
+    auto temporary_path = path;
+    temporary_path += ".tmp";
+    const std::vector<int> keys = {1, 2, 3};
+    EXPECT_THROW(write_tree_snapshot<int>(path, keys.begin(), keys.end(), keys.size() + 1), std::logic_error);
+    EXPECT_FALSE(std::filesystem::exists(temporary_path));
+    EXPECT_EQ(tree.sorted_keys(), load_tree_snapshot<OrderStatisticTree>(path).sorted_keys());
+}
+
+TEST_F(MappedOrderStatisticTreeTestSuite, MappedTreeIsMovable) {
+    OrderStatisticTree tree;
+    for (int key = 0; key < 100; key++)
+        tree.insert(key);
+    save_tree_snapshot(tree, path);
+    MappedOrderStatisticTree<> mapped(path);
+    MappedOrderStatisticTree<> moved(std::move(mapped));
+    EXPECT_EQ(50, moved.less_count(50));
+    mapped = std::move(moved);
+    EXPECT_EQ(42, mapped.find_order_statistic(43));
+}
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <set>
+
+#include "NodeArena.h"
+#include "OrderStatisticTree.h"
+
+using ArenaOrderStatisticTree = BasicOrderStatisticTree<int, std::less<int>, NoAugmentation, NodeArena<int>>;
+
+TEST(NodeArenaTest, ReusesFreedSlots) {
+    NodeArena<long, 4> arena;
+    long *first = arena.allocate(1);
+    long *second = arena.allocate(1);
+    EXPECT_NE(first, second);
+    arena.deallocate(first, 1);
+    EXPECT_EQ(first, arena.allocate(1));
+    EXPECT_EQ(4 * sizeof(long), arena.allocated_bytes());
+}
+
+TEST(NodeArenaTest, GrowsBySlabs) {
+    NodeArena<long, 4> arena;
+    for (int i = 0; i < 9; i++)
+        EXPECT_NE(nullptr, arena.allocate(1));
+    EXPECT_EQ(3 * 4 * sizeof(long), arena.allocated_bytes());
+    arena.release();
+    EXPECT_EQ(0, arena.allocated_bytes());
+}
+
+TEST(NodeArenaTest, CopyIsEmptyArena) {
+    NodeArena<long, 4> arena;
+    EXPECT_NE(nullptr, arena.allocate(1));
+    NodeArena<long, 4> copy(arena);
+    EXPECT_EQ(0, copy.allocated_bytes());
+    EXPECT_FALSE(copy == arena);
+}
+
+TEST(NodeArenaTest, ArenaTreeAnswersLikeHeapTree) {
+    std::mt19937 engine(42);
+    std::uniform_int_distribution<int> uniform_dist(-100000, 100000);
+    OrderStatisticTree heap_tree;
+    ArenaOrderStatisticTree arena_tree;
+    std::set<int> keys;
+    for (int i = 0; i < 10000; i++) {
+        const int key = uniform_dist(engine);
+        EXPECT_EQ(heap_tree.insert(key).second, arena_tree.insert(key).second);
+        keys.insert(key);
+    }
+    EXPECT_EQ(keys.size(), arena_tree.size());
+    std::size_t k = 1;
+    for (const auto key: keys) {
+        EXPECT_EQ(key, arena_tree.find_order_statistic(k));
+        EXPECT_EQ(heap_tree.less_count(key), arena_tree.less_count(key));
+        k++;
+    }
+}
+
+TEST(NodeArenaTest, CopyAndMoveArenaTree) {
+    ArenaOrderStatisticTree tree;
+    for (int i = 0; i < 1000; i++)
+        tree.insert(i);
+
+    ArenaOrderStatisticTree copy(tree);
+    EXPECT_TRUE(copy == tree);
+    tree.clear();
+    EXPECT_TRUE(tree.empty());
+    EXPECT_EQ(1000, copy.size());
+
+    ArenaOrderStatisticTree moved(std::move(copy));
+    EXPECT_EQ(0, copy.size());
+    EXPECT_EQ(1000, moved.size());
+    EXPECT_EQ(500, moved.less_count(500));
+}
+
+TEST(NodeArenaTest, CopyEmptyTree) {
+    OrderStatisticTree empty;
+    OrderStatisticTree copy(empty);
+    EXPECT_TRUE(copy.empty());
+    EXPECT_TRUE(copy == empty);
+}
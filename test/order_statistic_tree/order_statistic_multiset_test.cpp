@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+#include <queue>
+#include <random>
+#include <set>
+
+#include "OrderStatisticTree.h"
+
+class OrderStatisticMultisetTestSuite : public testing::Test, public OrderStatisticMultiset {
+public:
+    OrderStatisticMultiset &tree() {
+        return *static_cast<OrderStatisticMultiset *>(this);
+    }
+
+    /**
+     * Checks that the counts sum the multiplicities and that the tree matches the expected multiset.
+     */
+    void check_tree(const std::multiset<int> &expected) {
+        std::size_t distinct = 0;
+        std::queue<const Node *> queue;
+        if (root)
+            queue.push(root);
+        while (!queue.empty()) {
+            const auto node = queue.front();
+            queue.pop();
+            distinct++;
+            EXPECT_EQ(node->left_count() + node->right_count() + node->multiplicity.value, node->count);
+            EXPECT_EQ(expected.count(node->key), node->multiplicity.value);
+            if (node->left)
+                queue.push(node->left);
+            if (node->right)
+                queue.push(node->right);
+        }
+        EXPECT_EQ(std::set<int>(expected.begin(), expected.end()).size(), distinct);
+        EXPECT_EQ(expected.size(), size());
+        EXPECT_EQ(std::vector<int>(expected.begin(), expected.end()), sorted_keys());
+    }
+};
+
+static std::vector<int> generate_duplicated_keys(std::size_t n, int distinct) {
+    std::mt19937 engine(42);
+    std::uniform_int_distribution<int> uniform_dist(0, distinct - 1);
+    std::vector<int> keys(n);
+    for (auto &key: keys)
+        key = uniform_dist(engine);
+    return keys;
+}
+
+TEST_F(OrderStatisticMultisetTestSuite, InsertDuplicates) {
+    std::multiset<int> expected;
+    for (const auto key: generate_duplicated_keys(10000, 100)) {
+        const auto [position, inserted] = insert(key);
+        EXPECT_TRUE(inserted);
+        EXPECT_EQ(key, *position);
+        expected.insert(key);
+    }
+    check_tree(expected);
+}
+
+TEST_F(OrderStatisticMultisetTestSuite, RankQueries) {
+    std::multiset<int> expected;
+    for (const auto key: generate_duplicated_keys(10000, 100)) {
+        insert(key);
+        expected.insert(key);
+    }
+    for (int key = -1; key <= 100; key++)
+        EXPECT_EQ(std::distance(expected.begin(), expected.lower_bound(key)), less_count(key));
+    std::size_t k = 1;
+    for (const auto key: expected)
+        EXPECT_EQ(key, find_order_statistic(k++));
+}
+
+TEST_F(OrderStatisticMultisetTestSuite, Erase) {
+    std::mt19937 engine(42);
+    std::uniform_int_distribution<int> uniform_dist(0, 50);
+    std::multiset<int> expected;
+    for (int i = 0; i < 20000; i++) {
+        const int key = uniform_dist(engine);
+        if (i % 10 == 0) {
+            EXPECT_EQ(expected.erase(key), erase(key));
+        } else if (i % 3 == 0) {
+            const auto position = find(key);
+            EXPECT_EQ(expected.contains(key), position != end());
+            if (position != end()) {
+                erase(position);
+                expected.erase(expected.find(key));
+            }
+        } else {
+            insert(key);
+            expected.insert(key);
+        }
+    }
+    check_tree(expected);
+}
+
+TEST_F(OrderStatisticMultisetTestSuite, EraseKth) {
+    insert(1);
+    insert(2);
+    insert(2);
+    insert(2);
+    insert(3);
+    EXPECT_EQ(2, erase_kth(3));
+    EXPECT_EQ(3, erase_kth(4));
+    EXPECT_EQ(1, erase_kth(1));
+    check_tree({2, 2});
+}
+
+TEST_F(OrderStatisticMultisetTestSuite, IterateOccurrences) {
+    insert(5);
+    insert(7);
+    insert(5);
+    EXPECT_EQ((std::vector<int>{5, 5, 7}), std::vector<int>(begin(), end()));
+    EXPECT_EQ((std::vector<int>{7, 5, 5}),
+              std::vector<int>(std::make_reverse_iterator(end()), std::make_reverse_iterator(begin())));
+    auto position = erase(find(5));
+    EXPECT_EQ(5, *position);
+    position = erase(position);
+    EXPECT_EQ(7, *position);
+    EXPECT_EQ(1, size());
+}
+
+TEST_F(OrderStatisticMultisetTestSuite, BuildAndBulkInsert) {
+    auto keys = generate_duplicated_keys(5000, 300);
+    std::sort(keys.begin(), keys.end());
+    tree() = build_from_sorted(keys);
+    std::multiset<int> expected(keys.begin(), keys.end());
+    check_tree(expected);
+
+    for (const std::size_t batch: {10, 5000}) {
+        const auto added = generate_duplicated_keys(batch, 600);
+        EXPECT_EQ(batch, bulk_insert(added));
+        expected.insert(added.begin(), added.end());
+        check_tree(expected);
+    }
+    EXPECT_THROW(build_from_sorted(std::vector<int>{2, 1}), std::invalid_argument);
+}
+
+TEST_F(OrderStatisticMultisetTestSuite, CopyTree) {
+    for (const auto key: generate_duplicated_keys(1000, 10))
+        insert(key);
+    OrderStatisticMultiset other = tree();
+    EXPECT_TRUE(other == tree());
+    other.insert(0);
+    EXPECT_TRUE(other != tree());
+}
+
+TEST_F(OrderStatisticMultisetTestSuite, UniteAndSplit) {
+    std::multiset<int> expected;
+    OrderStatisticMultiset other;
+    for (const auto key: generate_duplicated_keys(5000, 300)) {
+        insert(key);
+        expected.insert(key);
+    }
+    for (const auto key: generate_duplicated_keys(3000, 500)) {
+        other.insert(key);
+        expected.insert(key);
+    }
+    unite(std::move(other));
+    check_tree(expected);
+
+    auto greater = split(150);
+    std::multiset<int> expected_greater(expected.lower_bound(150), expected.end());
+    expected.erase(expected.lower_bound(150), expected.end());
+    check_tree(expected);
+    tree() = std::move(greater);
+    check_tree(expected_greater);
+}
+
+TEST_F(OrderStatisticMultisetTestSuite, BatchQueries) {
+    for (const auto key: generate_duplicated_keys(1 << 18, 200))
+        insert(key);
+    std::vector<int> keys(300);
+    std::vector<std::size_t> ranks(size());
+    for (std::size_t i = 0; i < keys.size(); i++)
+        keys[i] = static_cast<int>(i) - 50;
+    for (std::size_t k = 1; k <= size(); k++)
+        ranks[k - 1] = k;
+    std::vector<std::size_t> counts(keys.size());
+    std::vector<int> found(ranks.size());
+    less_count_batch(keys, counts);
+    find_order_statistic_batch(ranks, found);
+    for (std::size_t i = 0; i < keys.size(); i++)
+        EXPECT_EQ(less_count(keys[i]), counts[i]);
+    EXPECT_EQ(sorted_keys(), found);
+}
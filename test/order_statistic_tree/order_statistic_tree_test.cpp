@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include <queue>
 #include <random>
+#include <set>
 #include <unordered_set>
 
 #include "OrderStatisticTree.h"
@@ -24,6 +25,37 @@ public:
         }
     }
 
+    OrderStatisticTree &tree() {
+        return *static_cast<OrderStatisticTree *>(this);
+    }
+
+    /**
+     * Checks colors, black heights, parent links and counts of the whole tree.
+     */
+    void check_invariants() {
+        if (!root)
+            return;
+        EXPECT_EQ(Node::Color::BLACK, root->color);
+        EXPECT_EQ(nullptr, root->parent);
+        for (const auto node: bfs()) {
+            EXPECT_EQ(node->left_count() + node->right_count() + 1, node->count);
+            if (node->color == Node::Color::RED && node->parent) {
+                EXPECT_EQ(Node::Color::BLACK, node->parent->color);
+            }
+            if (node->left) {
+                EXPECT_EQ(node, node->left->parent);
+            }
+            if (node->right) {
+                EXPECT_EQ(node, node->right->parent);
+            }
+            const int left_height = black_height(node->left) +
+                                    ((node->left && node->left->color == Node::Color::BLACK) ? 1 : 0);
+            const int right_height = black_height(node->right) +
+                                     ((node->right && node->right->color == Node::Color::BLACK) ? 1 : 0);
+            EXPECT_EQ(left_height, right_height);
+        }
+    }
+
     std::vector<Node *> bfs() {
         std::vector<Node *> nodes;
         std::queue<Node *> queue;
@@ -96,7 +128,9 @@ TEST_F(OrderStatisticTreeTestSuite, InsertionNotUnique) {
     insert(keys);
     for (const auto key: keys) {
         EXPECT_TRUE(contains(key));
-        EXPECT_FALSE(OrderStatisticTree::insert(key));
+        const auto [position, inserted] = OrderStatisticTree::insert(key);
+        EXPECT_FALSE(inserted);
+        EXPECT_EQ(key, *position);
     }
 }
 
@@ -126,6 +160,17 @@ TEST_F(OrderStatisticTreeTestSuite, LessCounts) {
     EXPECT_EQ(keys.size(), less_count(keys.back() + 1));
 }
 
+TEST_F(OrderStatisticTreeTestSuite, LessCountsRandomKeys) {
+    const auto unique_keys = generate_keys(10000);
+    insert(unique_keys);
+    std::vector<int> keys(unique_keys.begin(), unique_keys.end());
+    std::sort(keys.begin(), keys.end());
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        EXPECT_EQ(i, less_count(keys[i]));
+        EXPECT_EQ(keys[i], find_order_statistic(i + 1));
+    }
+}
+
 TEST_F(OrderStatisticTreeTestSuite, OrderStatistics) {
     auto keys = generate_serial_keys(static_cast<int>(10e5));
     insert(keys);
@@ -154,3 +199,227 @@ TEST_F(OrderStatisticTreeTestSuite, MoveTree) {
     EXPECT_TRUE(this_tree == new_tree);
     EXPECT_EQ(0, temp.size());
 }
+
+TEST_F(OrderStatisticTreeTestSuite, BuildFromSorted) {
+    for (const int n: {0, 1, 2, 3, 4, 5, 6, 7, 8, 100, 1000, 1023, 1024, 10000}) {
+        const auto keys = generate_serial_keys(n);
+        tree() = build_from_sorted(keys);
+        EXPECT_EQ(keys.size(), size());
+        check_invariants();
+        for (std::size_t i = 0; i < keys.size(); i++) {
+            EXPECT_EQ(i, less_count(keys[i]));
+            EXPECT_EQ(keys[i], find_order_statistic(i + 1));
+        }
+    }
+}
+
+TEST_F(OrderStatisticTreeTestSuite, BuildFromUnsortedKeys) {
+    EXPECT_THROW(build_from_sorted(std::vector<int>{1, 3, 2}), std::invalid_argument);
+    EXPECT_THROW(build_from_sorted(std::vector<int>{1, 2, 2}), std::invalid_argument);
+}
+
+TEST_F(OrderStatisticTreeTestSuite, InsertAfterBuildFromSorted) {
+    tree() = build_from_sorted(generate_serial_keys(1000));
+    for (int key = 1000; key < 2000; key++)
+        EXPECT_TRUE(OrderStatisticTree::insert(key).second);
+    check_invariants();
+    EXPECT_EQ(generate_serial_keys(2000), sorted_keys());
+}
+
+TEST_F(OrderStatisticTreeTestSuite, BulkInsert) {
+    std::mt19937 engine(42);
+    std::uniform_int_distribution<int> uniform_dist(-50000, 50000);
+    std::set<int> expected;
+    for (const int batch_size: {10000, 10, 50000, 1}) {
+        std::vector<int> batch(batch_size);
+        for (auto &key: batch)
+            key = uniform_dist(engine);
+        const auto old_size = expected.size();
+        expected.insert(batch.begin(), batch.end());
+        EXPECT_EQ(expected.size() - old_size, bulk_insert(batch));
+        EXPECT_EQ(expected.size(), size());
+        check_invariants();
+        EXPECT_EQ(std::vector<int>(expected.begin(), expected.end()), sorted_keys());
+    }
+}
+
+TEST_F(OrderStatisticTreeTestSuite, InsertReturnsPosition) {
+    for (const auto key: generate_keys(1000)) {
+        const auto [position, inserted] = OrderStatisticTree::insert(key);
+        EXPECT_TRUE(inserted);
+        EXPECT_EQ(key, *position);
+        EXPECT_EQ(position, find(key));
+    }
+    check_invariants();
+}
+
+TEST_F(OrderStatisticTreeTestSuite, Iteration) {
+    const auto unique_keys = generate_keys(1000);
+    insert(unique_keys);
+    std::vector<int> keys(unique_keys.begin(), unique_keys.end());
+    std::sort(keys.begin(), keys.end());
+    EXPECT_TRUE(std::equal(keys.begin(), keys.end(), begin(), end()));
+    EXPECT_TRUE(std::equal(keys.rbegin(), keys.rend(),
+                           std::make_reverse_iterator(end()), std::make_reverse_iterator(begin())));
+    EXPECT_EQ(end(), find(keys.back() == INT_MAX ? keys.front() - 1 : keys.back() + 1));
+}
+
+TEST_F(OrderStatisticTreeTestSuite, EraseKeys) {
+    std::mt19937 engine(42);
+    std::uniform_int_distribution<int> uniform_dist(0, 2000);
+    std::set<int> expected;
+    for (int i = 0; i < 20000; i++) {
+        const int key = uniform_dist(engine);
+        if (i % 3 == 0) {
+            EXPECT_EQ(expected.erase(key), erase(key));
+        } else {
+            expected.insert(key);
+            OrderStatisticTree::insert(key);
+        }
+    }
+    check_invariants();
+    EXPECT_EQ(expected.size(), size());
+    EXPECT_EQ(std::vector<int>(expected.begin(), expected.end()), sorted_keys());
+    std::size_t i = 0;
+    for (const auto key: expected) {
+        EXPECT_EQ(i, less_count(key));
+        EXPECT_EQ(key, find_order_statistic(i + 1));
+        i++;
+    }
+}
+
+TEST_F(OrderStatisticTreeTestSuite, EraseAllKeys) {
+    auto keys = generate_serial_keys(1000);
+    insert(keys);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+    for (const auto key: keys) {
+        EXPECT_EQ(1, erase(key));
+        EXPECT_EQ(0, erase(key));
+        check_invariants();
+    }
+    EXPECT_TRUE(empty());
+    EXPECT_EQ(0, size());
+}
+
+TEST_F(OrderStatisticTreeTestSuite, EraseKth) {
+    insert(generate_serial_keys(1000));
+    EXPECT_EQ(0, erase_kth(1));
+    EXPECT_EQ(999, erase_kth(size()));
+    EXPECT_EQ(500, erase_kth(500));
+    EXPECT_THROW(erase_kth(0), std::logic_error);
+    EXPECT_THROW(erase_kth(size() + 1), std::logic_error);
+    check_invariants();
+    EXPECT_EQ(997, size());
+    EXPECT_EQ(499, less_count(501));
+    EXPECT_FALSE(contains(500));
+}
+
+TEST_F(OrderStatisticTreeTestSuite, EraseByIterator) {
+    insert(generate_serial_keys(100));
+    auto position = find(10);
+    while (position != end() && *position < 20)
+        position = erase(position);
+    EXPECT_EQ(20, *position);
+    EXPECT_EQ(90, size());
+    EXPECT_EQ(10, less_count(20));
+    check_invariants();
+}
+
+static OrderStatisticTree tree_of_range(int first, int last) {
+    OrderStatisticTree tree;
+    for (int key = first; key < last; key++)
+        tree.insert(key);
+    return tree;
+}
+
+TEST_F(OrderStatisticTreeTestSuite, JoinTrees) {
+    for (const auto &[left_size, right_size]: std::vector<std::pair<int, int>>{
+            {0, 0}, {0, 10}, {1, 1000}, {1000, 1}, {10000, 37}, {500, 500}}) {
+        tree() = join(tree_of_range(0, left_size), left_size, tree_of_range(left_size + 1, left_size + right_size + 1));
+        check_invariants();
+        EXPECT_EQ(generate_serial_keys(left_size + right_size + 1), sorted_keys());
+
+        tree() = join(tree_of_range(0, left_size), tree_of_range(left_size, left_size + right_size));
+        check_invariants();
+        EXPECT_EQ(generate_serial_keys(left_size + right_size), sorted_keys());
+    }
+    EXPECT_THROW(join(tree_of_range(0, 10), 5, tree_of_range(11, 20)), std::invalid_argument);
+    EXPECT_THROW(join(tree_of_range(0, 10), tree_of_range(9, 20)), std::invalid_argument);
+}
+
+TEST_F(OrderStatisticTreeTestSuite, SplitTree) {
+    for (const int key: {-5, 0, 2000, 5001, 9999, 20000}) {
+        clear();
+        for (int i = 0; i < 5000; i++)
+            OrderStatisticTree::insert(i * 2);
+        const auto greater = split(key);
+        check_invariants();
+        const auto less = std::min(std::max((key + 1) / 2, 0), 5000);
+        EXPECT_EQ(less, size());
+        EXPECT_EQ(5000 - less, greater.size());
+        EXPECT_TRUE(empty() || *std::prev(end()) < key);
+        EXPECT_TRUE(greater.empty() || *greater.begin() >= key);
+
+        tree() = greater;
+        check_invariants();
+    }
+}
+
+TEST_F(OrderStatisticTreeTestSuite, UniteTrees) {
+    std::mt19937 engine(42);
+    std::uniform_int_distribution<int> uniform_dist(0, 100000);
+    for (const std::size_t max_threads: {1, 4}) {
+        for (const auto &[first_size, second_size]: std::vector<std::pair<int, int>>{
+                {0, 100}, {100, 0}, {10, 50000}, {40000, 40000}}) {
+            clear();
+            OrderStatisticTree other;
+            std::set<int> expected;
+            for (int i = 0; i < first_size; i++) {
+                const auto key = uniform_dist(engine);
+                OrderStatisticTree::insert(key);
+                expected.insert(key);
+            }
+            for (int i = 0; i < second_size; i++) {
+                const auto key = uniform_dist(engine);
+                other.insert(key);
+                expected.insert(key);
+            }
+            unite(std::move(other), max_threads);
+            check_invariants();
+            EXPECT_EQ(std::vector<int>(expected.begin(), expected.end()), sorted_keys());
+        }
+    }
+}
+
+TEST_F(OrderStatisticTreeTestSuite, BatchQueries) {
+    std::vector<int> keys(1000);
+    std::vector<std::size_t> counts(keys.size());
+    less_count_batch(keys, counts);
+    EXPECT_EQ(std::vector<std::size_t>(keys.size(), 0), counts);
+
+    // Big enough for the interleaved lanes, smaller trees are queried one by one.
+    const auto tree_keys = generate_serial_keys(1 << 18);
+    insert(tree_keys);
+    std::mt19937 engine(42);
+    std::uniform_int_distribution<int> key_dist(-10, (1 << 18) + 10);
+    std::uniform_int_distribution<std::size_t> rank_dist(1, size());
+    std::vector<std::size_t> ranks(keys.size());
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        keys[i] = key_dist(engine);
+        ranks[i] = rank_dist(engine);
+    }
+    keys[0] = find_order_statistic(1);
+    keys[1] = find_order_statistic(size());
+
+    less_count_batch(keys, counts);
+    std::vector<int> found(ranks.size());
+    find_order_statistic_batch(ranks, found);
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        EXPECT_EQ(less_count(keys[i]), counts[i]);
+        EXPECT_EQ(find_order_statistic(ranks[i]), found[i]);
+    }
+
+    ranks.back() = size() + 1;
+    EXPECT_THROW(find_order_statistic_batch(ranks, found), std::logic_error);
+    EXPECT_THROW(less_count_batch(keys, std::span(counts).first(1)), std::invalid_argument);
+}
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <set>
+
+#include "PersistentOrderStatisticTree.h"
+
+class PersistentOrderStatisticTreeTestSuite : public testing::Test, public PersistentOrderStatisticTree {
+public:
+    /**
+     * Checks the counts and the weight balance of every node, returns the subtree size.
+     */
+    static std::size_t check_subtree(const Node *node) {
+        if (!node)
+            return 0;
+        const auto left_size = check_subtree(node->left.get());
+        const auto right_size = check_subtree(node->right.get());
+        EXPECT_EQ(left_size + right_size + 1, node->count);
+        if (left_size + right_size > 1) {
+            EXPECT_LE(left_size, DELTA * right_size);
+            EXPECT_LE(right_size, DELTA * left_size);
+        }
+        return node->count;
+    }
+
+    void check_tree(const std::set<int> &expected) {
+        EXPECT_EQ(expected.size(), check_subtree(root.get()));
+        EXPECT_EQ(std::vector<int>(expected.begin(), expected.end()), sorted_keys());
+    }
+};
+
+TEST_F(PersistentOrderStatisticTreeTestSuite, InsertAndErase) {
+    std::mt19937 engine(42);
+    std::uniform_int_distribution<int> uniform_dist(0, 3000);
+    std::set<int> expected;
+    for (int i = 0; i < 20000; i++) {
+        const int key = uniform_dist(engine);
+        if (i % 3 == 0)
+            EXPECT_EQ(expected.erase(key), erase(key));
+        else
+            EXPECT_EQ(expected.insert(key).second, insert(key));
+    }
+    check_tree(expected);
+    std::size_t i = 0;
+    for (const auto key: expected) {
+        EXPECT_EQ(i, less_count(key));
+        EXPECT_EQ(key, find_order_statistic(++i));
+        EXPECT_TRUE(contains(key));
+    }
+    EXPECT_THROW((void) find_order_statistic(0), std::logic_error);
+}
+
+TEST_F(PersistentOrderStatisticTreeTestSuite, SortedInsertionIsBalanced) {
+    std::set<int> expected;
+    for (int key = 0; key < 10000; key++) {
+        insert(key);
+        expected.insert(key);
+    }
+    check_tree(expected);
+}
+
+TEST_F(PersistentOrderStatisticTreeTestSuite, SnapshotIsNotChanged) {
+    for (int key = 0; key < 100; key++)
+        insert(key);
+    const auto old = snapshot();
+    EXPECT_TRUE(old == *this);
+    for (int key = 0; key < 100; key += 2)
+        erase(key);
+    insert(1000);
+
+    EXPECT_EQ(100, old.size());
+    EXPECT_EQ(50, old.less_count(50));
+    EXPECT_FALSE(old.contains(1000));
+    EXPECT_EQ(51, size());
+    EXPECT_EQ(25, less_count(50));
+    EXPECT_FALSE(old == *this);
+}
+
+TEST_F(PersistentOrderStatisticTreeTestSuite, UnchangedTreeSharesRoot) {
+    insert(1);
+    const auto old_root = root;
+    EXPECT_FALSE(insert(1));
+    EXPECT_EQ(0, erase(2));
+    EXPECT_EQ(old_root, root);
+}
+
+TEST(VersionedOrderStatisticTreeTest, QueriesAsOfVersion) {
+    VersionedOrderStatisticTree tree;
+    EXPECT_TRUE(tree.insert(10));
+    EXPECT_TRUE(tree.insert(20));
+    EXPECT_FALSE(tree.insert(20));
+    EXPECT_TRUE(tree.insert(5));
+    EXPECT_EQ(1, tree.erase(10));
+    EXPECT_EQ(0, tree.erase(10));
+
+    EXPECT_EQ(4, tree.current_version());
+    EXPECT_EQ(0, tree.at(0).size());
+    EXPECT_EQ(1, tree.less_count(15, 2));
+    EXPECT_EQ(2, tree.less_count(15, 3));
+    EXPECT_EQ(1, tree.less_count(15, 4));
+    EXPECT_EQ(10, tree.find_order_statistic(2, 3));
+    EXPECT_EQ(20, tree.find_order_statistic(2, 4));
+    EXPECT_THROW((void) tree.at(5), std::out_of_range);
+}
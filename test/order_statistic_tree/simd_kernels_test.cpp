@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "SimdKernels.h"
+
+static std::vector<CountLessKernel> count_less_kernels() {
+    std::vector<CountLessKernel> kernels{count_less_scalar, count_less};
+#ifdef ORDER_STATISTIC_TREE_X86_KERNELS
+    if (__builtin_cpu_supports("sse4.2"))
+        kernels.push_back(count_less_sse);
+    if (__builtin_cpu_supports("avx2"))
+        kernels.push_back(count_less_avx2);
+#endif
+    return kernels;
+}
+
+static std::vector<FindRankChildKernel> find_rank_child_kernels() {
+    std::vector<FindRankChildKernel> kernels{find_rank_child_scalar, find_rank_child};
+#ifdef ORDER_STATISTIC_TREE_X86_KERNELS
+    if (__builtin_cpu_supports("sse4.2"))
+        kernels.push_back(find_rank_child_sse);
+    if (__builtin_cpu_supports("avx2"))
+        kernels.push_back(find_rank_child_avx2);
+#endif
+    return kernels;
+}
+
+TEST(SimdKernelsTest, CountLess) {
+    std::mt19937 engine(42);
+    std::uniform_int_distribution<int> uniform_dist(INT_MIN, INT_MAX);
+    for (std::size_t n = 0; n <= 64; n++) {
+        std::vector<int> keys(n);
+        for (auto &key: keys)
+            key = uniform_dist(engine);
+        std::sort(keys.begin(), keys.end());
+
+        std::vector<int> queries{INT_MIN, INT_MAX, 0};
+        for (const auto key: keys) {
+            queries.push_back(key);
+            if (key != INT_MAX)
+                queries.push_back(key + 1);
+        }
+        for (const auto query: queries) {
+            const auto expected = static_cast<std::size_t>(
+                    std::lower_bound(keys.begin(), keys.end(), query) - keys.begin());
+            for (const auto kernel: count_less_kernels())
+                EXPECT_EQ(expected, kernel(keys.data(), n, query));
+        }
+    }
+}
+
+TEST(SimdKernelsTest, FindRankChild) {
+    std::mt19937 engine(42);
+    std::uniform_int_distribution<std::size_t> count_dist(1, 1000);
+    for (std::size_t n = 1; n <= 64; n++) {
+        std::vector<std::size_t> counts(n);
+        for (auto &count: counts)
+            count = count_dist(engine);
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            for (const auto k: {total + 1, total + counts[i] / 2 + 1, total + counts[i]}) {
+                for (const auto kernel: find_rank_child_kernels()) {
+                    std::size_t rest = k;
+                    EXPECT_EQ(i, kernel(counts.data(), n, rest));
+                    EXPECT_EQ(k - total, rest);
+                }
+            }
+            total += counts[i];
+        }
+        // k beyond the sum of counts clamps to the last child in every version.
+        for (const auto kernel: find_rank_child_kernels()) {
+            std::size_t rest = total + 5;
+            EXPECT_EQ(n - 1, kernel(counts.data(), n, rest));
+            EXPECT_EQ(counts[n - 1] + 5, rest);
+        }
+    }
+}